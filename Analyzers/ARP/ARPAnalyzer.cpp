@@ -19,14 +19,19 @@ void ARPAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
     timespec ts = rawPacket->getPacketTimeStamp();
 
     // Update the host manager with the ARP data
-    auto arpData = std::make_unique<ARPData>(ts, srcMac, srcIp, dstIp);
+    ARPData arpData(ts, srcMac, srcIp, dstIp);
     
     #ifdef DEBUG
     std::cout << "ARP Data:" << std::endl;
-    std::cout << "\tSender MAC: " << arpData->senderMac << std::endl;
-    std::cout << "\tSender IP: " << arpData->senderIp << std::endl;
-    std::cout << "\tTarget IP: " << arpData->targetIp << std::endl;
+    std::cout << "\tSender MAC: " << arpData.senderMac << std::endl;
+    std::cout << "\tSender IP: " << arpData.senderIp << std::endl;
+    std::cout << "\tTarget IP: " << arpData.targetIp << std::endl;
     #endif
    
-   hostManager.updateHost(ProtocolType::ARP, std::move(arpData));
+   hostManager.updateHost(std::move(arpData));
+}
+
+// ARP ethertype
+AnalyzerInterests ARPAnalyzer::getInterests() const {
+    return {{0x0806}, {}, {}, {}, {}};
 }
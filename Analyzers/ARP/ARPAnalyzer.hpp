@@ -19,6 +19,9 @@ public:
     ARPAnalyzer(HostManager& hostManager) : Analyzer(hostManager) {}
     // Method to analyze a packet (overrides the virtual method in Analyzer)
     void analyzePacket(pcpp::Packet& parsedPacket) override;
+    AnalyzerInterests getInterests() const override;
+    // The ARP layer is the network layer
+    pcpp::OsiModelLayer getParseDepth() const override { return pcpp::OsiModelNetworkLayer; }
 };
 
 #endif // DHCP_ANALYZER_HPP
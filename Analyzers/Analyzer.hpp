@@ -1,7 +1,7 @@
 #ifndef ANALYZER_HPP
 #define ANALYZER_HPP
 
-#define DEBUG
+// DEBUG (print every analyzed packet) is defined by the build, see the NETPROBE_DEBUG option
 
 #include "PcapLiveDeviceList.h"
 #include "PcapLiveDevice.h"
@@ -15,8 +15,10 @@
 #include "TcpLayer.h"
 #include "MacAddress.h"
 #include "../Hosts/HostManager.hpp"
+#include "../Layers/Frame/FrameView.hpp"
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <string>
 #include <thread>
 #include <chrono>
@@ -24,6 +26,28 @@
 #include <arpa/inet.h>
 #include <unordered_set>
 
+/**
+ * @struct AnalyzerInterests
+ * @brief Frames an analyzer wants to receive.
+ *
+ * Each field lists one kind of match key, a frame is of interest as soon as it matches any
+ * key of any kind. The CaptureManager compiles the union of the interests of all analyzers
+ * into the kernel capture filter, so every frame no analyzer asked for is discarded before
+ * reaching userspace.
+ */
+struct AnalyzerInterests {
+    // Ethernet II ethertypes (e.g. 0x0806 for ARP)
+    std::vector<uint16_t> etherTypes;
+    // UDP source or destination ports, over IPv4 or IPv6
+    std::vector<uint16_t> udpPorts;
+    // 802.2 LLC destination SAPs of 802.3 frames (e.g. 0x42 for STP)
+    std::vector<uint8_t> llcSaps;
+    // SNAP protocol IDs of 802.3 LLC/SNAP frames (e.g. 0x2000 for CDP)
+    std::vector<uint16_t> snapPids;
+    // Destination multicast MAC addresses
+    std::vector<pcpp::MacAddress> dstMacs;
+};
+
 // Base Analyzer class
 /**
  * @class Analyzer
@@ -32,6 +56,13 @@
  * The Analyzer class provides an interface for analyzing specific protocol packets.
  * Derived classes must implement the analyzePacket method to handle the analysis
  * of packets for different protocols.
+ *
+ * Analyzers that only read a few fixed header fields can opt in to the FrameView fast path by
+ * overriding usesFrameView() and analyzeFrame(): the frame is then never parsed for them. The
+ * others get a pcpp::Packet parsed down to the layer returned by getParseDepth().
+ *
+ * The Layer parsers an analyzer builds allocate their temporaries from the scratch resource,
+ * the PacketArena of the worker, released after every frame.
  */
 
 class Analyzer {
@@ -46,9 +77,31 @@ public:
     * @param packet Reference to a pcpp::Packet object to be analyzed.
     */
     virtual void analyzePacket(pcpp::Packet& packet) = 0;
+    /**
+    * @brief Declares the frames this analyzer matches on.
+    *
+    * @return The ethertypes, UDP ports, LLC SAPs, SNAP PIDs and multicast MACs of interest.
+    */
+    virtual AnalyzerInterests getInterests() const = 0;
+    /**
+    * @brief Analyzes a frame from the view over its raw headers.
+    *
+    * Called instead of analyzePacket when usesFrameView() returns true.
+    *
+    * @param frame View over the frame, valid only during the call.
+    */
+    virtual void analyzeFrame(const FrameView& frame) {}
+    // Whether the analyzer works on the FrameView alone and needs no parsed packet
+    virtual bool usesFrameView() const { return false; }
+    // Deepest OSI layer the packet must be parsed down to for analyzePacket
+    virtual pcpp::OsiModelLayer getParseDepth() const { return pcpp::OsiModelApplicationLayer; }
+    // Allocate the parser temporaries from a resource released after every frame
+    void setScratch(std::pmr::memory_resource* resource) { scratch = resource; }
 protected:
     // Host manager reference
     HostManager& hostManager;
+    // Memory for the temporaries of the frame being analyzed, the global heap unless set
+    std::pmr::memory_resource* scratch = std::pmr::get_default_resource();
 };
 
 #endif // ANALYZER_HPP
@@ -1,5 +1,4 @@
 #include "CDPAnalyzer.hpp"
-#include "EthDot3Layer.h"
 
 #include <iostream>
 #include <iomanip>
@@ -13,52 +12,54 @@ const uint8_t CDP_MULTICAST_ADDR[6] = {0x01, 0x00, 0x0c, 0xcc, 0xcc, 0xcc};
 
 // Méthode pour analyser un paquet CDP
 void CDPAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
-    
-    pcpp::EthDot3Layer* ethLayer = parsedPacket.getLayerOfType<pcpp::EthDot3Layer>();
-    if (ethLayer == nullptr) {
+    analyzeFrame(FrameView(*parsedPacket.getRawPacket()));
+}
+
+// Analyze a CDP frame from its header view
+void CDPAnalyzer::analyzeFrame(const FrameView& frame) {
+    // CDP is carried over LLC/SNAP
+    if (!frame.hasSnap()) {
         return;
     }
 
-    const uint8_t* payload = ethLayer->getLayerPayload();
-    const size_t payloadSize = ethLayer->getLayerPayloadSize();
-    const uint32_t logicalLinkControl = (payload[0] << 16 | payload[1] << 8 | payload[2]);
-    uint16_t protocolID;
-    // Check the DSAP and SSAP fields
-    uint8_t dsap = payload[0];
-    uint8_t ssap = payload[1];
-    uint8_t control = payload[2];
-
-    if (dsap == 0xAA && ssap == 0xAA && control == 0x03) {
-        // This is an LLC+SNAP header
-        uint32_t organizationCode = (payload[3] << 16) | (payload[4] << 8) | payload[5];
-        protocolID = (payload[6] << 8) | payload[7];
+    if (frame.getSnapPid() != 0x2000) {
+        return;
     }
 
-    if (protocolID != 0x2000) {
+    timespec ts = frame.getTimestamp();
+
+    // Skip the LLC/SNAP header and the CDP version, TTL and checksum
+    const uint8_t* payload = frame.getL2Payload();
+    const size_t payloadSize = frame.getL2PayloadLength();
+    if (payloadSize < 12) {
         return;
     }
 
-    pcpp::RawPacket* rawPacket = parsedPacket.getRawPacket();
-    timespec ts = rawPacket->getPacketTimeStamp();
-
     // Create CDPLayer 
-    CDPLayer cdpLayer(payload + 12, payloadSize - 12);
-    
-    std::string ethLayerStr = ethLayer->toString();
-    std::string srcPrefix = "Src: ";
-    size_t srcPos = ethLayerStr.find(srcPrefix);
-    size_t macStartPos = srcPos + srcPrefix.length();
-    std::string srcMacStr = ethLayerStr.substr(macStartPos, 17);
+    CDPLayer cdpLayer(payload + 12, payloadSize - 12, scratch);
+
+    pcpp::MacAddress srcMac = frame.getSrcMac();
 
-    pcpp::MacAddress srcMac(srcMacStr);
+    // A device announcing itself again only refreshes the kept observation, with the holdtime of the header
+    if (hostManager.refreshHost<CDPData>(srcMac, pcpp::IPv4Address::Zero, ts, payload[9],
+                                         [&cdpLayer](const CDPData& kept) { return kept.repeatedBy(cdpLayer); })) {
+        return;
+    }
 
     auto cdpData = std::make_unique<CDPData>(ts, srcMac, cdpLayer);
+    // Holdtime of the CDP header, after the LLC/SNAP header and the version
+    cdpData->ttl = payload[9];
     
     #ifdef DEBUG
     std::cout << "CDP Data:" << std::endl;
     std::cout << cdpLayer << std::endl;
     #endif
         
-    hostManager.updateHost(ProtocolType::CDP, std::move(cdpData));
+    hostManager.updateHost(std::move(cdpData));
 }
 
+
+// CDP is carried over LLC/SNAP with the Cisco protocol ID
+AnalyzerInterests CDPAnalyzer::getInterests() const {
+    return {{}, {}, {}, {0x2000}, {}};
+}
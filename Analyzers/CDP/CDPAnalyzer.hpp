@@ -14,6 +14,10 @@ class CDPAnalyzer : public Analyzer {
 public:
     CDPAnalyzer(HostManager& hostManager) : Analyzer(hostManager) {}
     void analyzePacket(pcpp::Packet& parsedPacket) override;
+    AnalyzerInterests getInterests() const override;
+    // Fast path, the analyzer only reads fixed header fields
+    void analyzeFrame(const FrameView& frame) override;
+    bool usesFrameView() const override { return true; }
 };
 
 #endif // CDP_ANALYZER_H
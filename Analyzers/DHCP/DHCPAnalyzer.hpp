@@ -25,6 +25,7 @@ public:
     DHCPAnalyzer(HostManager& hostManager) : Analyzer(hostManager) {}
     // Method to analyze a packet (overrides the virtual method in Analyzer)
     void analyzePacket(pcpp::Packet& parsedPacket) override;
+    AnalyzerInterests getInterests() const override;
     
 };
 
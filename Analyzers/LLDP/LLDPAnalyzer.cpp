@@ -1,48 +1,56 @@
 #include "LLDPAnalyzer.hpp"
 #include "PcapFileDevice.h"
 #include "PcapLiveDeviceList.h"
-#include "EthLayer.h"
-#include "IPv4Layer.h"
-#include "UdpLayer.h"
 
 
 // Method to analyze a packet (overrides the virtual method in Analyzer)
 void LLDPAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
-    // Check if the packet has Ethernet layer
-    pcpp::EthLayer* ethLayer = parsedPacket.getLayerOfType<pcpp::EthLayer>();
-    if (ethLayer == nullptr) {
-        return; // No Ethernet layer, exit the function
-    }
+    analyzeFrame(FrameView(*parsedPacket.getRawPacket()));
+}
 
+// Method to analyze a frame from its header view (overrides the virtual method in Analyzer)
+void LLDPAnalyzer::analyzeFrame(const FrameView& frame) {
     // check if the packet is an LLDP packet
-    if (ethLayer->getEthHeader()->etherType != 0xcc88) {
+    if (frame.getEtherType() != 0x88cc) {
         return; // Not an LLDP packet, exit
     }
 
-    pcpp::RawPacket* rawPacket = parsedPacket.getRawPacket();
-    timespec ts = rawPacket->getPacketTimeStamp();
+    timespec ts = frame.getTimestamp();
 
     // LLDP uses a special EtherType (0x88cc)
-    LLDPLayer lldpLayer(ethLayer->getLayerPayload(), ethLayer->getLayerPayloadSize());
+    LLDPLayer lldpLayer(frame.getL2Payload(), frame.getL2PayloadLength(), scratch);
 
     // Extract the sender MAC address and system name
-    pcpp::MacAddress senderMac = ethLayer->getSourceMac();
+    pcpp::MacAddress senderMac = frame.getSrcMac();
+
+    // A device announcing itself again only refreshes the kept observation
+    if (hostManager.refreshHost<LLDPData>(senderMac, pcpp::IPv4Address::Zero, ts, lldpLayer.getTTL(),
+                                          [&lldpLayer](const LLDPData& kept) { return kept.repeatedBy(lldpLayer); })) {
+        return;
+    }
+
     std::string portID = lldpLayer.getPortId();
     std::string portDescription = lldpLayer.getPortDescription();
     std::string systemName = lldpLayer.getSystemName();
     std::string systemDescription = lldpLayer.getSystemDescription();
 
     // Create an LLDPData object
-    auto lldpData = std::make_unique<LLDPData>(ts, senderMac, portID, portDescription, systemName, systemDescription);
+    LLDPData lldpData(ts, senderMac, std::move(portID), std::move(portDescription), std::move(systemName), std::move(systemDescription));
+    lldpData.ttl = lldpLayer.getTTL();
     
     #ifdef DEBUG
     std::cout << "LLDP Data:" << std::endl;
-    std::cout << "\tSender MAC: " << lldpData->senderMAC << std::endl;
-    std::cout << "\tPort ID: " << lldpData->portID << std::endl;
-    std::cout << "\tPort Description: " << lldpData->portDescription << std::endl;
-    std::cout << "\tSystem Name: " << lldpData->systemName << std::endl;
-    std::cout << "\tSystem Description: " << lldpData->systemDescription << std::endl;
+    std::cout << "\tSender MAC: " << lldpData.senderMAC << std::endl;
+    std::cout << "\tPort ID: " << lldpData.portID << std::endl;
+    std::cout << "\tPort Description: " << lldpData.portDescription << std::endl;
+    std::cout << "\tSystem Name: " << lldpData.systemName << std::endl;
+    std::cout << "\tSystem Description: " << lldpData.systemDescription << std::endl;
     #endif
     
-    hostManager.updateHost(ProtocolType::LLDP, std::move(lldpData));
+    hostManager.updateHost(std::move(lldpData));
+}
+
+// LLDP ethertype
+AnalyzerInterests LLDPAnalyzer::getInterests() const {
+    return {{0x88cc}, {}, {}, {}, {}};
 }
@@ -53,33 +53,54 @@ void SSDPAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
         return; // No payload found, exit the function
     }
 
-    SSDPLayer ssdpLayer(payload, payloadSize);
+    SSDPLayer ssdpLayer(payload, payloadSize, scratch);
     //std::cout << ssdpLayer << std::endl;
 
     // Extract IP address of the sender (source IP)
+    pcpp::IPv4Address clientIP = pcpp::IPv4Address::Zero;
     pcpp::IPv4Layer* ipLayer = parsedPacket.getLayerOfType<pcpp::IPv4Layer>();
     if (ipLayer != nullptr) {
-        clientIP = ipLayer->getSrcIPAddress().toString();
+        clientIP = ipLayer->getSrcIPAddress();
     }
 
     // Extract MAC address of the sender (source MAC)
+    pcpp::MacAddress clientMAC = pcpp::MacAddress::Zero;
     pcpp::EthLayer* ethLayer = parsedPacket.getLayerOfType<pcpp::EthLayer>();
     if (ethLayer != nullptr) {
-        clientMAC = ethLayer->getSourceMac().toString();
+        clientMAC = ethLayer->getSourceMac();
     }
 
-    auto ssdpData = std::make_unique<SSDPData>(parsedPacket.getRawPacket()->getPacketTimeStamp(), pcpp::MacAddress(clientMAC), pcpp::IPv4Address(clientIP), ssdpLayer.getSSDPType(), ssdpLayer.getSSDPHeaders());
+    // A device announcing itself again only refreshes the kept observation
+    timespec ts = parsedPacket.getRawPacket()->getPacketTimeStamp();
+    if (hostManager.refreshHost<SSDPData>(clientMAC, clientIP, ts, 0,
+                                          [&ssdpLayer, clientIP](const SSDPData& kept) { return kept.repeatedBy(ssdpLayer, clientIP); })) {
+        return;
+    }
+
+    // Intern the headers straight from the payload, a known header costs no copy
+    SSDPData::Headers headers;
+    headers.reserve(ssdpLayer.getSSDPHeaders().size());
+    for (const auto& [name, value] : ssdpLayer.getSSDPHeaders()) {
+        headers.emplace_back(name, value);
+    }
+
+    SSDPData ssdpData(ts, clientMAC, clientIP, ssdpLayer.getSSDPType(), std::move(headers));
     
     #ifdef DEBUG
     std::cout << "SSDP Data:" << std::endl;
-    std::cout << "\tClient MAC: " << ssdpData->senderMAC << std::endl;
-    std::cout << "\tClient IP: " << ssdpData->senderIP << std::endl;
-    std::cout << "\tSSDP Type: " << ssdpData->ssdpType << std::endl;
+    std::cout << "\tClient MAC: " << ssdpData.senderMAC << std::endl;
+    std::cout << "\tClient IP: " << ssdpData.senderIP << std::endl;
+    std::cout << "\tSSDP Type: " << ssdpData.ssdpType << std::endl;
     std::cout << "\tSSDP Headers:" << std::endl;
-    for (const auto& header : ssdpData->ssdpHeaders) {
+    for (const auto& header : ssdpData.ssdpHeaders) {
         std::cout << "\t\t" << header.first << ": " << header.second << std::endl;
     }
     #endif
     
-    hostManager.updateHost(ProtocolType::SSDP, std::move(ssdpData));
+    hostManager.updateHost(std::move(ssdpData));
+}
+
+// SSDP port
+AnalyzerInterests SSDPAnalyzer::getInterests() const {
+    return {{}, {1900}, {}, {}, {}};
 }
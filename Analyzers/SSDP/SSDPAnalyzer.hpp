@@ -14,10 +14,6 @@ private:
     std::string location;
     std::string usn;
     std::string server;
-
-    // Variables for M-SEARCH requests
-    std::string clientIP;
-    std::string clientMAC;
     
     std::map<std::string, std::string> ssdpMap; // Store SSDP details, keyed by USN or Location
 
@@ -25,6 +21,9 @@ public:
     SSDPAnalyzer(HostManager& hostManager) : Analyzer(hostManager) {}
     // Method to analyze a packet (overrides the virtual method in Analyzer)
     void analyzePacket(pcpp::Packet& parsedPacket) override;
+    AnalyzerInterests getInterests() const override;
+    // SSDP is read from the raw UDP payload
+    pcpp::OsiModelLayer getParseDepth() const override { return pcpp::OsiModelTransportLayer; }
 
     // Print captured SSDP information
     void printHostMap();
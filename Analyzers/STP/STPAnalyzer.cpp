@@ -1,48 +1,50 @@
 #include "STPAnalyzer.hpp"
 #include "PcapFileDevice.h"
 #include "PcapLiveDeviceList.h"
-#include "EthDot3Layer.h"
-#include "IPv4Layer.h"
-#include "UdpLayer.h"
 
 
 // Method to analyze a packet (overrides the virtual method in Analyzer)
 void STPAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
-    // Check if the packet has Ethernet layer
-    pcpp::EthDot3Layer* ethLayer = parsedPacket.getLayerOfType<pcpp::EthDot3Layer>();
-    if (ethLayer == nullptr) {
-        return; // No Ethernet layer, exit the function
+    analyzeFrame(FrameView(*parsedPacket.getRawPacket()));
+}
+
+// Method to analyze a frame from its header view (overrides the virtual method in Analyzer)
+void STPAnalyzer::analyzeFrame(const FrameView& frame) {
+    // Check if the frame is an 802.3 frame with an LLC header
+    if (!frame.hasLlc()) {
+        return; // No LLC header, exit the function
     }
 
-    const uint8_t* payload = ethLayer->getLayerPayload();
-    const uint32_t logicalLinkControl = (payload[0] << 16 | payload[1] << 8 | payload[2]);
-    const uint16_t protocolID = logicalLinkControl >> 8;
-
-    if (protocolID != 0x4242) {
+    // Both SAPs are the bridge SAP on STP BPDUs
+    if (frame.getDsap() != 0x42 || frame.getSsap() != 0x42) {
         return; // Not an STP packet, exit
     }
 
-    pcpp::RawPacket* rawPacket = parsedPacket.getRawPacket();
-    timespec ts = rawPacket->getPacketTimeStamp();
+    timespec ts = frame.getTimestamp();
+
+    const uint8_t* payload = frame.getL2Payload();
+    size_t payloadSize = frame.getL2PayloadLength();
+    if (payloadSize < 6) {
+        return;
+    }
 
-    STPLayer stplayer(payload + 6, ethLayer->getLayerPayloadSize() - 6);
+    STPLayer stplayer(payload + 6, payloadSize - 6);
     STPLayer::BridgeIdentifier bridgeIdentifier = stplayer.getBridgeIdentifier();
     STPLayer::RootIdentifier rootIdentifier = stplayer.getRootIdentifier();
 
-    std::string ethLayerStr = ethLayer->toString();
-    std::string srcPrefix = "Src: ";
-    size_t srcPos = ethLayerStr.find(srcPrefix);
-    size_t macStartPos = srcPos + srcPrefix.length();
-    std::string srcMacStr = ethLayerStr.substr(macStartPos, 17);
+    pcpp::MacAddress srcMac = frame.getSrcMac();
 
-    pcpp::MacAddress srcMac(srcMacStr);
-
-    auto stpData = std::make_unique<STPData>(ts, srcMac, rootIdentifier, bridgeIdentifier);
+    STPData stpData(ts, srcMac, rootIdentifier, bridgeIdentifier);
     
     #ifdef DEBUG
     std::cout << "STP Data:" << std::endl;
     std::cout << stplayer << std::endl;
     #endif
     
-    hostManager.updateHost(ProtocolType::STP, std::move(stpData));
-}
\ No newline at end of file
+    hostManager.updateHost(std::move(stpData));
+}
+
+// STP BPDUs use the 802.1D bridge SAP
+AnalyzerInterests STPAnalyzer::getInterests() const {
+    return {{}, {}, {0x42}, {}, {}};
+}
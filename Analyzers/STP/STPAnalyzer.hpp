@@ -32,6 +32,10 @@ public:
     STPAnalyzer(HostManager& hostManager) : Analyzer(hostManager) {}
     // Method to analyze a packet (overrides the virtual method in Analyzer)
     void analyzePacket(pcpp::Packet& parsedPacket) override;
+    AnalyzerInterests getInterests() const override;
+    // Fast path, the analyzer only reads fixed header fields
+    void analyzeFrame(const FrameView& frame) override;
+    bool usesFrameView() const override { return true; }
 };
 
 #endif // LLDP_ANALYZER_HPP
@@ -1,33 +1,39 @@
 #include "WOLAnalyzer.hpp"
 
 void WOLAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
-    // Check if the packet has Ethernet layer
-    pcpp::EthLayer* ethLayer = parsedPacket.getLayerOfType<pcpp::EthLayer>();
-    if (ethLayer == nullptr) {
-        return; // No Ethernet layer, exit the function
-    }
+    analyzeFrame(FrameView(*parsedPacket.getRawPacket()));
+}
+
+void WOLAnalyzer::analyzeFrame(const FrameView& frame) {
     // check if the packet is a WOL packet
-    if (ethLayer->getEthHeader()->etherType != 0x4208) {
+    if (frame.getEtherType() != 0x0842) {
         return; // Not a WOL packet, exit
     }
 
-    pcpp::RawPacket* rawPacket = parsedPacket.getRawPacket();
-    timespec ts = rawPacket->getPacketTimeStamp();
+    timespec ts = frame.getTimestamp();
 
     // Get the mac address of the source 
-    pcpp::MacAddress sourceMacAddr = ethLayer->getSourceMac();
+    pcpp::MacAddress sourceMacAddr = frame.getSrcMac();
 
-    // Get the mac address of the target in the WOL payload 
-    pcpp::MacAddress targetMacAddrStr = pcpp::MacAddress(ethLayer->getLayerPayload() + 6);
+    // Get the mac address of the target in the WOL payload, after the 6 bytes of synchronization stream
+    if (frame.getL2PayloadLength() < 12) {
+        return;
+    }
+    pcpp::MacAddress targetMacAddrStr = pcpp::MacAddress(frame.getL2Payload() + 6);
 
     // Create a WOLData object
-    auto wolData = std::make_unique<WOLData>(ts, sourceMacAddr, targetMacAddrStr);
+    WOLData wolData(ts, sourceMacAddr, targetMacAddrStr);
     
     #ifdef DEBUG
     std::cout << "WOL Data:" << std::endl;
-    std::cout << "\tSource MAC: " << wolData->senderMAC << std::endl;
-    std::cout << "\tTarget MAC: " << wolData->targetMAC << std::endl;
+    std::cout << "\tSource MAC: " << wolData.senderMAC << std::endl;
+    std::cout << "\tTarget MAC: " << wolData.targetMAC << std::endl;
     #endif
     
-    hostManager.updateHost(ProtocolType::WOL, std::move(wolData));
-}
\ No newline at end of file
+    hostManager.updateHost(std::move(wolData));
+}
+
+// Wake-on-LAN ethertype
+AnalyzerInterests WOLAnalyzer::getInterests() const {
+    return {{0x0842}, {}, {}, {}, {}};
+}
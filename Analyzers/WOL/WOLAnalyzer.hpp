@@ -22,6 +22,10 @@ class WOLAnalyzer : public Analyzer {
   public:
     WOLAnalyzer(HostManager& hostManager) : Analyzer(hostManager) {}
     void analyzePacket(pcpp::Packet& parsedPacket) override;
+    AnalyzerInterests getInterests() const override;
+    // Fast path, the analyzer only reads fixed header fields
+    void analyzeFrame(const FrameView& frame) override;
+    bool usesFrameView() const override { return true; }
 };
 
 #endif // WOL_ANALYZER_HPP
\ No newline at end of file
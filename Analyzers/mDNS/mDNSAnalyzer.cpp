@@ -1,5 +1,7 @@
 #include "mDNSAnalyzer.hpp"
 
+#include <algorithm>
+
 void mDNSAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
     // Check if the packet is Ethernet, IPv4, and UDP
     pcpp::EthLayer* ethLayer = parsedPacket.getLayerOfType<pcpp::EthLayer>();
@@ -21,6 +23,8 @@ void mDNSAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
 
     pcpp::MacAddress srcMac = ethLayer->getSourceMac();
     std::string queriedDomain, hostname, ipAddress;
+    // Shortest TTL of the address records answered
+    uint32_t ttl = 0;
 
     // Extract the DNS queries/responses (assuming mDNS)
     if (dnsLayer->getQueryCount() > 0) {
@@ -36,6 +40,7 @@ void mDNSAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
             if (answer->getType() == pcpp::DNS_TYPE_A) {
                 hostname = answer->getName();
                 ipAddress = answer->getData()->toString();
+                ttl = ttl == 0 ? answer->getTTL() : std::min(ttl, answer->getTTL());
                 // edit the protcol data with the response 
             }
         }
@@ -45,15 +50,21 @@ void mDNSAnalyzer::analyzePacket(pcpp::Packet& parsedPacket) {
     timespec ts = rawPacket->getPacketTimeStamp();  
 
     // Update the host manager with the mDNS data
-    auto mdnsData = std::make_unique<mDNSData>(ts, queriedDomain, srcMac, hostname, ipAddress);
+    mDNSData mdnsData(ts, queriedDomain, srcMac, hostname, ipAddress);
+    mdnsData.ttl = ttl;
     
     #ifdef DEBUG
     std::cout << "mDNS Data:" << std::endl;
-    std::cout << "\tQueried Domain: " << mdnsData->queriedDomain << std::endl;
-    std::cout << "\tClient MAC: " << mdnsData->clientMac << std::endl;
-    std::cout << "\tHostname: " << mdnsData->hostname << std::endl;
-    std::cout << "\tIP Address: " << mdnsData->ipAddress << std::endl;
+    std::cout << "\tQueried Domain: " << mdnsData.queriedDomain << std::endl;
+    std::cout << "\tClient MAC: " << mdnsData.clientMac << std::endl;
+    std::cout << "\tHostname: " << mdnsData.hostname << std::endl;
+    std::cout << "\tIP Address: " << mdnsData.ipAddress << std::endl;
     #endif
 
-    hostManager.updateHost(ProtocolType::MDNS, std::move(mdnsData));
+    hostManager.updateHost(std::move(mdnsData));
+}
+
+// mDNS port
+AnalyzerInterests mDNSAnalyzer::getInterests() const {
+    return {{}, {5353}, {}, {}, {}};
 }
@@ -22,6 +22,7 @@ class mDNSAnalyzer : public Analyzer {
 public:
     mDNSAnalyzer(HostManager& hostManager) : Analyzer(hostManager) {}
     void analyzePacket(pcpp::Packet& parsedPacket) override;
+    AnalyzerInterests getInterests() const override;
 };
 
 #endif // DNS_ANALYZER_HPP
\ No newline at end of file
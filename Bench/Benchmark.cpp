@@ -0,0 +1,642 @@
+#include "../Capture/AnalysisWorker.hpp"
+#include "../Analyzers/DHCP/DHCPAnalyzer.hpp"
+#include "../Analyzers/ARP/ARPAnalyzer.hpp"
+#include "../Analyzers/STP/STPAnalyzer.hpp"
+#include "../Analyzers/SSDP/SSDPAnalyzer.hpp"
+#include "../Analyzers/CDP/CDPAnalyzer.hpp"
+#include "../Analyzers/LLDP/LLDPAnalyzer.hpp"
+#include "../Analyzers/WOL/WOLAnalyzer.hpp"
+#include "../Hosts/ObservationLog.hpp"
+#include "PcapFileDevice.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+/**
+ * @file Benchmark.cpp
+ * @brief Throughput benchmark of the analysis pipeline over the bundled capture files.
+ *
+ * Every capture file under the pcaps directory is loaded into memory, then replayed through
+ * an AnalysisWorker (frame classifier, analyzers and HostManager) on the calling thread, so
+ * neither disk nor capture is measured. Each protocol directory is one benchmark case, and
+ * all the frames together form the end-to-end case. A multiplier replays extra copies of the
+ * frames with rewritten source MAC addresses, to measure the pipeline with more hosts.
+ *
+ * The stress mode instead runs the host store concurrently, writers analyzing frames while
+ * readers take host snapshots, to be run under ThreadSanitizer.
+ *
+ * The scale case fills a host store with synthetic ARP hosts and reports the memory held per
+ * host, the figure that bounds how many hosts fit in a sensor.
+ */
+
+// Heap allocations made by the process, counted by the replaced operator new
+static std::atomic<uint64_t> allocationCount{0};
+static std::atomic<uint64_t> allocationBytes{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+struct Frame {
+    std::vector<uint8_t> data;
+    timespec timestamp;
+};
+
+struct BenchCase {
+    std::string name;
+    std::vector<Frame> frames;
+};
+
+struct Result {
+    std::string name;
+    uint64_t packets = 0;
+    uint64_t errors = 0;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    size_t hosts = 0;
+    // Memory held by the pool of the host store at the end of the run
+    SlabResource::Stats pool;
+    // Strings interned by the observations of the run
+    StringInterner::Stats strings;
+    long peakRssKb = 0;
+    std::chrono::nanoseconds elapsed{0};
+
+    double packetsPerSecond() const {
+        return elapsed.count() ? packets * 1e9 / elapsed.count() : 0.0;
+    }
+    double nsPerPacket() const {
+        return packets ? double(elapsed.count()) / packets : 0.0;
+    }
+    double allocationsPerPacket() const {
+        return packets ? double(allocations) / packets : 0.0;
+    }
+};
+
+struct Options {
+    std::string pcapsDir = "pcaps";
+    std::string manufFile = "Hosts/manuf";
+    std::string jsonFile;
+    unsigned iterations = 10;
+    unsigned multiplier = 1;
+    unsigned stressSeconds = 0;
+    unsigned readers = 4;
+    size_t scaleHosts = 1000000;
+};
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--pcaps DIR] [--manuf FILE] [--iterations N] [--multiplier M] [--hosts N] [--json FILE]" << std::endl
+              << "  --pcaps DIR       capture files to replay, one protocol per subdirectory (default: pcaps)" << std::endl
+              << "  --manuf FILE      vendor database (default: Hosts/manuf)" << std::endl
+              << "  --iterations N    replays of every case (default: 10)" << std::endl
+              << "  --multiplier M    copies of every frame, each with rewritten source MACs (default: 1)" << std::endl
+              << "  --hosts N         synthetic hosts of the scale case, 0 to skip it (default: 1000000)" << std::endl
+              << "  --json FILE       also write the results as JSON" << std::endl
+              << "  --stress SECONDS  run writers and snapshot readers concurrently instead (default: off)" << std::endl
+              << "  --readers N       snapshot reader threads of the stress mode (default: 4)" << std::endl;
+}
+
+// Read every frame of a capture file into memory
+bool loadFile(const std::string& path, std::vector<Frame>& frames) {
+    std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(path));
+    if (reader == nullptr || !reader->open()) {
+        std::cerr << "Error: Unable to open the capture file: " << path << std::endl;
+        return false;
+    }
+    pcpp::RawPacket rawPacket;
+    while (reader->getNextPacket(rawPacket)) {
+        const uint8_t* data = rawPacket.getRawData();
+        frames.push_back({std::vector<uint8_t>(data, data + rawPacket.getRawDataLen()), rawPacket.getPacketTimeStamp()});
+    }
+    reader->close();
+    return true;
+}
+
+// One case per protocol subdirectory and per capture file at the top of the directory
+std::vector<BenchCase> loadCases(const std::string& directory) {
+    namespace fs = std::filesystem;
+    auto isCapture = [](const fs::path& path) {
+        return path.extension() == ".pcap" || path.extension() == ".pcapng";
+    };
+
+    std::vector<fs::directory_entry> entries(fs::directory_iterator(directory), fs::directory_iterator{});
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.path() < b.path(); });
+
+    std::vector<BenchCase> cases;
+    for (const fs::directory_entry& entry : entries) {
+        BenchCase benchCase;
+        if (entry.is_directory()) {
+            benchCase.name = entry.path().filename().string();
+            std::vector<fs::path> files;
+            for (const fs::directory_entry& file : fs::directory_iterator(entry.path())) {
+                if (isCapture(file.path())) {
+                    files.push_back(file.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            for (const fs::path& file : files) {
+                loadFile(file.string(), benchCase.frames);
+            }
+        } else if (isCapture(entry.path())) {
+            benchCase.name = entry.path().stem().string();
+            loadFile(entry.path().string(), benchCase.frames);
+        }
+        if (!benchCase.frames.empty()) {
+            cases.push_back(std::move(benchCase));
+        }
+    }
+    return cases;
+}
+
+/**
+ * Appends copies of the frames where the Ethernet source MAC is replaced by a synthetic one.
+ *
+ * The vendor prefix is kept and the copy index is folded into the low bytes. Every occurrence
+ * of the original address in the frame is rewritten, so that the ARP sender and DHCP client
+ * addresses the analyzers key hosts on move along with it.
+ */
+void multiply(std::vector<Frame>& frames, unsigned multiplier) {
+    size_t original = frames.size();
+    frames.reserve(original * multiplier);
+    for (unsigned copy = 1; copy < multiplier; copy++) {
+        for (size_t i = 0; i < original; i++) {
+            Frame frame = frames[i];
+            if (frame.data.size() < 14) {
+                frames.push_back(std::move(frame));
+                continue;
+            }
+            uint8_t source[6], rewritten[6];
+            std::memcpy(source, frame.data.data() + 6, 6);
+            std::memcpy(rewritten, source, 6);
+            rewritten[3] ^= (copy >> 16) & 0xff;
+            rewritten[4] ^= (copy >> 8) & 0xff;
+            rewritten[5] ^= copy & 0xff;
+            for (size_t offset = 6; offset + 6 <= frame.data.size(); offset++) {
+                if (std::memcmp(frame.data.data() + offset, source, 6) == 0) {
+                    std::memcpy(frame.data.data() + offset, rewritten, 6);
+                }
+            }
+            frames.push_back(std::move(frame));
+        }
+    }
+}
+
+// Reset the peak resident set size of the process, when the kernel allows it
+void resetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs) {
+        clearRefs << "5";
+    }
+}
+
+// Current resident set size in kB
+long rssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// Peak resident set size in kB since the last reset
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+template <typename AnalyzerType>
+AnalyzerFactory factory() {
+    return [](HostManager& hostManager) {
+        return std::unique_ptr<Analyzer>(new AnalyzerType(hostManager));
+    };
+}
+
+// Replay the frames through a fresh pipeline, the first pass creates the hosts, the next ones update them
+Result run(const std::string& name, const std::vector<Frame>& frames, unsigned iterations) {
+    // Same analyzers as the netprobe executable
+    std::vector<AnalyzerFactory> factories = {
+        factory<DHCPAnalyzer>(), factory<ARPAnalyzer>(), factory<STPAnalyzer>(), factory<SSDPAnalyzer>(),
+        factory<CDPAnalyzer>(), factory<LLDPAnalyzer>(), factory<WOLAnalyzer>(),
+    };
+
+    Result result;
+    result.name = name;
+    resetPeakRss();
+    {
+        AnalysisWorker worker(0, 1, factories, {"bench"});
+
+        uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+        uint64_t bytes = allocationBytes.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned iteration = 0; iteration < iterations; iteration++) {
+            for (const Frame& frame : frames) {
+                pcpp::RawPacket rawPacket(frame.data.data(), static_cast<int>(frame.data.size()), frame.timestamp, false);
+                result.errors += worker.handlePacket(0, &rawPacket);
+            }
+        }
+        result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        result.allocations = allocationCount.load(std::memory_order_relaxed) - allocations;
+        result.allocatedBytes = allocationBytes.load(std::memory_order_relaxed) - bytes;
+        result.packets = uint64_t(frames.size()) * iterations;
+
+        worker.withHosts([&result](HostManager& hostManager) {
+            result.hosts = hostManager.getHostMap().size();
+            result.pool = hostManager.getMemoryStats();
+            result.strings = StringInterner::global().getStats();
+        });
+    }
+    result.peakRssKb = peakRssKb();
+    return result;
+}
+
+/**
+ * Analyzes the frames in a loop from two writers while reader threads take host snapshots.
+ *
+ * One writer queues the frames to the analysis thread of the worker, the other analyzes them
+ * inline like a TPACKET_V3 capture thread, so both writer paths contend for the shard. The
+ * readers alternate fresh and last published snapshots and check that every snapshot they see
+ * is at least as recent as the previous one and holds no fewer hosts.
+ *
+ * @return The number of inconsistent snapshots seen, 0 on success.
+ */
+uint64_t stress(const std::vector<Frame>& frames, unsigned seconds, unsigned readerCount) {
+    std::vector<AnalyzerFactory> factories = {
+        factory<DHCPAnalyzer>(), factory<ARPAnalyzer>(), factory<STPAnalyzer>(), factory<SSDPAnalyzer>(),
+        factory<CDPAnalyzer>(), factory<LLDPAnalyzer>(), factory<WOLAnalyzer>(),
+    };
+    AnalysisWorker worker(0, 1024, factories, {"queued", "inline"});
+    worker.start();
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> inconsistent{0};
+    std::atomic<uint64_t> snapshots{0};
+    std::atomic<int64_t> maxReadNs{0};
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            for (const Frame& frame : frames) {
+                worker.enqueueBlocking(0, frame.data.data(), frame.data.size(), frame.timestamp);
+            }
+        }
+    });
+    threads.emplace_back([&]() {
+        while (running.load(std::memory_order_relaxed)) {
+            for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+                pcpp::RawPacket rawPacket(it->data.data(), static_cast<int>(it->data.size()), it->timestamp, false);
+                worker.handlePacket(1, &rawPacket);
+            }
+        }
+    });
+    for (unsigned reader = 0; reader < readerCount; reader++) {
+        threads.emplace_back([&, reader]() {
+            uint64_t generation = 0;
+            size_t hosts = 0;
+            for (uint64_t i = reader; running.load(std::memory_order_relaxed); i++) {
+                auto start = std::chrono::steady_clock::now();
+                std::shared_ptr<const HostSnapshot> snapshot = worker.getSnapshot(i % 2 == 0);
+                Json::Value hostsJson = snapshot->toJson();
+                int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+                if (snapshot->generation < generation || snapshot->size() < hosts || hostsJson.size() != snapshot->size()) {
+                    inconsistent.fetch_add(1, std::memory_order_relaxed);
+                }
+                generation = snapshot->generation;
+                hosts = snapshot->size();
+                snapshots.fetch_add(1, std::memory_order_relaxed);
+                int64_t longest = maxReadNs.load(std::memory_order_relaxed);
+                while (elapsed > longest && !maxReadNs.compare_exchange_weak(longest, elapsed)) {
+                }
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    worker.stop();
+
+    AnalysisWorker::Stats stats = worker.getStats();
+    std::shared_ptr<const HostSnapshot> last = worker.getSnapshot();
+    std::cout << "netprobe_bench stress: " << seconds << " s, 2 writers, " << readerCount << " reader(s)" << std::endl
+              << "  packets analyzed    " << stats.packets << std::endl
+              << "  snapshots read      " << snapshots.load() << std::endl
+              << "  snapshots published " << last->generation << std::endl
+              << "  hosts               " << last->size() << std::endl
+              << "  longest read        " << maxReadNs.load() / 1000 << " us" << std::endl
+              << "  inconsistent        " << inconsistent.load() << std::endl;
+    return inconsistent.load();
+}
+
+// Figures of the observation log measured over one pass of the frames
+struct LogResult {
+    uint64_t packets = 0;
+    uint64_t observations = 0;
+    uint64_t bytes = 0;
+    uint64_t replayed = 0;
+    std::chrono::nanoseconds analysis{0};
+    std::chrono::nanoseconds replay{0};
+    size_t hosts = 0;
+
+    double nsPerPacket() const {
+        return packets ? double(analysis.count()) / packets : 0.0;
+    }
+    double bytesPerObservation() const {
+        return observations ? double(bytes) / observations : 0.0;
+    }
+    double replayedPerSecond() const {
+        return replay.count() ? replayed * 1e9 / replay.count() : 0.0;
+    }
+};
+
+/**
+ * Analyzes the frames once with an observation log attached, then replays the log into an
+ * empty host store as a restart does, measuring the size of the log and the replay throughput.
+ */
+LogResult logBench(const std::vector<Frame>& frames) {
+    std::vector<AnalyzerFactory> factories = {
+        factory<DHCPAnalyzer>(), factory<ARPAnalyzer>(), factory<STPAnalyzer>(), factory<SSDPAnalyzer>(),
+        factory<CDPAnalyzer>(), factory<LLDPAnalyzer>(), factory<WOLAnalyzer>(),
+    };
+    std::string path = (std::filesystem::temp_directory_path() / ("netprobe_bench_" + std::to_string(getpid()) + ".wal")).string();
+
+    LogResult result;
+    {
+        ObservationLog log(path);
+        log.open();
+        AnalysisWorker worker(0, 1, factories, {"bench"});
+        worker.withHosts([&log](HostManager& hostManager) {
+            hostManager.setObservationLog(&log);
+        });
+        auto start = std::chrono::steady_clock::now();
+        for (const Frame& frame : frames) {
+            pcpp::RawPacket rawPacket(frame.data.data(), static_cast<int>(frame.data.size()), frame.timestamp, false);
+            worker.handlePacket(0, &rawPacket);
+        }
+        result.analysis = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        result.packets = frames.size();
+        log.close();
+        ObservationLog::Stats stats = log.getStats();
+        result.observations = stats.records;
+        result.bytes = stats.bytes;
+    }
+
+    HostManager hostManager;
+    auto start = std::chrono::steady_clock::now();
+    ObservationLog::ReplayResult replay = ObservationLog::replay(path, [&hostManager](Observation observation) {
+        hostManager.replayObservation(std::move(observation));
+    });
+    result.replay = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    result.replayed = replay.observations;
+    result.hosts = hostManager.getHostMap().size();
+    std::filesystem::remove(path);
+    return result;
+}
+
+// Memory held by a host store of synthetic hosts
+struct ScaleResult {
+    size_t hosts = 0;
+    // Host table keys and indices, and the host records
+    uint64_t tableBytes = 0;
+    // Interfaces and observation histories, from the pool of the store
+    uint64_t poolBytes = 0;
+    long rssKb = 0;
+    std::chrono::nanoseconds elapsed{0};
+
+    double bytesPerHost() const {
+        return hosts ? double(tableBytes + poolBytes) / hosts : 0.0;
+    }
+    double rssBytesPerHost() const {
+        return hosts ? rssKb * 1024.0 / hosts : 0.0;
+    }
+};
+
+/**
+ * Adds the given number of hosts to an empty host store, each seen once by ARP with its own
+ * MAC and IPv4 address, the most common host of a large network.
+ */
+ScaleResult scaleBench(size_t hostCount) {
+    ScaleResult result;
+    long rssBefore = rssKb();
+    {
+        HostManager hostManager(hostCount);
+        hostManager.setIngress("bench");
+        timespec now{};
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < hostCount; i++) {
+            uint8_t mac[6] = {0x02, 0x00, uint8_t(i >> 24), uint8_t(i >> 16), uint8_t(i >> 8), uint8_t(i)};
+            pcpp::IPv4Address ip(htonl(0x0a000000u | (uint32_t(i) & 0x00ffffffu)));
+            hostManager.updateHost(ARPData(now, pcpp::MacAddress(mac), ip, pcpp::IPv4Address::Zero));
+        }
+        result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        result.hosts = hostManager.getHostMap().size();
+        result.tableBytes = hostManager.getHostMap().memoryUsage();
+        result.poolBytes = hostManager.getMemoryStats().bytesReserved;
+        result.rssKb = rssKb() - rssBefore;
+    }
+    return result;
+}
+
+void printResult(const Result& result) {
+    std::cout << std::left << std::setw(10) << result.name << std::right
+              << std::setw(12) << result.packets
+              << std::setw(14) << static_cast<uint64_t>(result.packetsPerSecond())
+              << std::setw(12) << std::fixed << std::setprecision(1) << result.nsPerPacket()
+              << std::setw(14) << std::setprecision(2) << result.allocationsPerPacket()
+              << std::setw(14) << std::setprecision(1) << (result.packets ? double(result.allocatedBytes) / result.packets : 0.0)
+              << std::setw(10) << result.hosts
+              << std::setw(12) << result.pool.bytesReserved / 1024
+              << std::setw(12) << result.peakRssKb
+              << std::setw(10) << result.errors << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (arg == "--pcaps") {
+            options.pcapsDir = argv[++i];
+        } else if (arg == "--manuf") {
+            options.manufFile = argv[++i];
+        } else if (arg == "--iterations") {
+            options.iterations = std::max(1ul, std::stoul(argv[++i]));
+        } else if (arg == "--multiplier") {
+            options.multiplier = std::max(1ul, std::stoul(argv[++i]));
+        } else if (arg == "--json") {
+            options.jsonFile = argv[++i];
+        } else if (arg == "--stress") {
+            options.stressSeconds = std::stoul(argv[++i]);
+        } else if (arg == "--readers") {
+            options.readers = std::max(1ul, std::stoul(argv[++i]));
+        } else if (arg == "--hosts") {
+            options.scaleHosts = std::stoul(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    loadVendorDatabase(options.manufFile, vendorDatabase);
+
+    std::vector<BenchCase> cases = loadCases(options.pcapsDir);
+    if (cases.empty()) {
+        std::cerr << "Error: No capture file found under " << options.pcapsDir << std::endl;
+        return 1;
+    }
+
+    // The end-to-end case replays every frame of every case
+    BenchCase all{"all", {}};
+    for (BenchCase& benchCase : cases) {
+        multiply(benchCase.frames, options.multiplier);
+        all.frames.insert(all.frames.end(), benchCase.frames.begin(), benchCase.frames.end());
+    }
+    cases.push_back(std::move(all));
+
+    if (options.stressSeconds > 0) {
+        return stress(cases.back().frames, options.stressSeconds, options.readers) == 0 ? 0 : 1;
+    }
+
+    std::cout << "netprobe_bench: " << options.iterations << " iteration(s), multiplier " << options.multiplier << std::endl;
+    std::cout << std::left << std::setw(10) << "case" << std::right
+              << std::setw(12) << "packets"
+              << std::setw(14) << "packets/s"
+              << std::setw(12) << "ns/packet"
+              << std::setw(14) << "allocs/packet"
+              << std::setw(14) << "bytes/packet"
+              << std::setw(10) << "hosts"
+              << std::setw(12) << "pool kB"
+              << std::setw(12) << "peak RSS kB"
+              << std::setw(10) << "malformed" << std::endl;
+
+    Json::Value resultsJson(Json::arrayValue);
+    for (const BenchCase& benchCase : cases) {
+        Result result = run(benchCase.name, benchCase.frames, options.iterations);
+        printResult(result);
+
+        Json::Value resultJson;
+        resultJson["CASE"] = result.name;
+        resultJson["PACKETS"] = Json::UInt64(result.packets);
+        resultJson["PACKETS PER SECOND"] = result.packetsPerSecond();
+        resultJson["NS PER PACKET"] = result.nsPerPacket();
+        resultJson["ALLOCATIONS PER PACKET"] = result.allocationsPerPacket();
+        resultJson["BYTES ALLOCATED PER PACKET"] = result.packets ? double(result.allocatedBytes) / result.packets : 0.0;
+        resultJson["HOSTS"] = Json::UInt64(result.hosts);
+        resultJson["HOST POOL KB"] = Json::UInt64(result.pool.bytesReserved / 1024);
+        resultJson["HOST POOL FRAGMENTATION"] = result.pool.fragmentation();
+        resultJson["INTERNED STRING KB"] = Json::UInt64(result.strings.bytes / 1024);
+        resultJson["STRING DEDUP RATIO"] = result.strings.dedupRatio();
+        resultJson["PEAK RSS KB"] = Json::Int64(result.peakRssKb);
+        resultJson["MALFORMED"] = Json::UInt64(result.errors);
+        resultsJson.append(resultJson);
+    }
+
+    // Write-ahead log of the end-to-end case
+    LogResult logResult = logBench(cases.back().frames);
+    std::cout << "observation log: " << logResult.observations << " observations, " << std::fixed << std::setprecision(1)
+              << logResult.bytesPerObservation() << " bytes/observation, analysis "
+              << logResult.nsPerPacket() << " ns/packet"
+              << ", replay " << static_cast<uint64_t>(logResult.replayedPerSecond()) << " observations/s ("
+              << logResult.replay.count() / 1e6 << " ms, " << logResult.hosts << " hosts)" << std::endl;
+
+    ScaleResult scaleResult;
+    if (options.scaleHosts > 0) {
+        scaleResult = scaleBench(options.scaleHosts);
+        std::cout << "host store: " << scaleResult.hosts << " hosts, " << std::setprecision(1)
+                  << scaleResult.bytesPerHost() << " bytes/host (table " << scaleResult.tableBytes / 1024
+                  << " kB, pool " << scaleResult.poolBytes / 1024 << " kB), RSS " << scaleResult.rssBytesPerHost()
+                  << " bytes/host, " << scaleResult.elapsed.count() / 1e6 << " ms" << std::endl;
+    }
+
+    if (!options.jsonFile.empty()) {
+        std::ofstream file(options.jsonFile);
+        if (!file.is_open()) {
+            std::cerr << "Error opening file!" << std::endl;
+            return 1;
+        }
+        Json::Value benchJson;
+        benchJson["ITERATIONS"] = options.iterations;
+        benchJson["MULTIPLIER"] = options.multiplier;
+        benchJson["RESULTS"] = resultsJson;
+        Json::Value logJson;
+        logJson["OBSERVATIONS"] = Json::UInt64(logResult.observations);
+        logJson["NS PER PACKET"] = logResult.nsPerPacket();
+        logJson["BYTES PER OBSERVATION"] = logResult.bytesPerObservation();
+        logJson["REPLAYED OBSERVATIONS PER SECOND"] = logResult.replayedPerSecond();
+        logJson["REPLAY MS"] = logResult.replay.count() / 1e6;
+        benchJson["OBSERVATION LOG"] = logJson;
+        if (options.scaleHosts > 0) {
+            Json::Value scaleJson;
+            scaleJson["HOSTS"] = Json::UInt64(scaleResult.hosts);
+            scaleJson["BYTES PER HOST"] = scaleResult.bytesPerHost();
+            scaleJson["RSS BYTES PER HOST"] = scaleResult.rssBytesPerHost();
+            scaleJson["TABLE KB"] = Json::UInt64(scaleResult.tableBytes / 1024);
+            scaleJson["HOST POOL KB"] = Json::UInt64(scaleResult.poolBytes / 1024);
+            scaleJson["INSERT MS"] = scaleResult.elapsed.count() / 1e6;
+            benchJson["HOST STORE"] = scaleJson;
+        }
+        file << benchJson;
+    }
+    return 0;
+}
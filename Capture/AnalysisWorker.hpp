@@ -0,0 +1,349 @@
+#ifndef ANALYSIS_WORKER_HPP
+#define ANALYSIS_WORKER_HPP
+
+#include "FrameClassifier.hpp"
+#include "PacketRing.hpp"
+#include "../Analyzers/Analyzer.hpp"
+#include "../Hosts/HostManager.hpp"
+#include "../Layers/PacketArena.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Builds one analyzer bound to the host shard of a worker
+using AnalyzerFactory = std::function<std::unique_ptr<Analyzer>(HostManager&)>;
+
+/**
+ * @class AnalysisWorker
+ *
+ * @brief Analysis thread owning one shard of the host store.
+ *
+ * Each AnalysisWorker owns one PacketRing per capture source, its own HostManager shard and
+ * its own set of analyzers bound to that shard. A worker built with a queue capacity of 0 has
+ * no rings, for the capture threads that analyze inline: its thread then only ages and publishes. Every ring has a single producer, the capture
+ * thread of its source, so they stay lock-free with several interfaces captured at once.
+ * Frames are dispatched to workers by host MAC address, so every update for a given host is
+ * applied by the same thread. The writer mutex of the shard is only taken per batch of frames,
+ * to serialize the analysis thread with capture threads analyzing inline; readers never take it.
+ * Observations are stamped with the name of the source they came from. The hosts of the shard
+ * are aged out from the writer side too, every ExpiryInterval, even while no frame arrives.
+ *
+ * Readers see the hosts through the HostSnapshot the shard publishes at most every
+ * SnapshotInterval while it changes, and as soon as a reader asks for a fresh one. Readers never
+ * take the writer mutex: asking only raises a flag, and the writer publishes at the end of its
+ * current batch, or on the next poll of the analysis thread while the rings are empty.
+ *
+ * Frames are not broadcast to every analyzer: their headers are classified once and looked up
+ * in a DispatchTable built from the analyzers' interests, and only the matching analyzers run.
+ * A frame no analyzer matches is never parsed into layers. Analyzers on the FrameView fast path
+ * read the raw headers in place; for the others the frame is parsed once, down to the deepest
+ * layer the matching analyzers need. The parser temporaries of a frame are allocated from
+ * the PacketArena of the worker, released in one go once every matching analyzer ran.
+ */
+class AnalysisWorker {
+  public:
+    struct Stats {
+        size_t id;
+        uint64_t packets;
+        uint64_t errors;
+        uint64_t unmatched;
+        std::chrono::nanoseconds busy;
+        PacketRing::Stats queue;
+        HostManager::AgingStats aging;
+        SlabResource::Stats memory;
+    };
+
+    AnalysisWorker(size_t id, size_t queueCapacity, const std::vector<AnalyzerFactory>& factories,
+                   const std::vector<std::string>& sourceNames)
+        : id(id) {
+        for (const std::string& source : sourceNames) {
+            sources.push_back(InternedString::pinned(source));
+            if (queueCapacity > 0) {
+                rings.push_back(std::make_unique<PacketRing>(queueCapacity));
+            }
+        }
+        for (const AnalyzerFactory& factory : factories) {
+            analyzers.push_back(factory(hostManager));
+            analyzers.back()->setScratch(scratch.get());
+            size_t index = analyzers.size() - 1;
+            dispatch.add(index, analyzers.back()->getInterests());
+            if (analyzers.back()->usesFrameView()) {
+                frameAnalyzers |= DispatchTable::Mask(1) << index;
+            }
+            parseDepths.push_back(analyzers.back()->getParseDepth());
+        }
+    }
+
+    ~AnalysisWorker() {
+        stop();
+    }
+
+    AnalysisWorker(const AnalysisWorker&) = delete;
+    AnalysisWorker& operator=(const AnalysisWorker&) = delete;
+
+    // Start the analysis thread
+    void start() {
+        running = true;
+        thread = std::thread(&AnalysisWorker::run, this);
+    }
+
+    // Stop the analysis thread once the frames already queued are processed
+    void stop() {
+        running = false;
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    // Capture side: queue a frame of a source, dropped and counted as an overflow if the ring is full
+    bool enqueue(size_t source, const uint8_t* data, size_t length, const timespec& timestamp) {
+        return rings[source]->push(data, length, timestamp);
+    }
+
+    // Replay side: queue a frame of a source, waiting for room instead of dropping it
+    void enqueueBlocking(size_t source, const uint8_t* data, size_t length, const timespec& timestamp) {
+        PacketRing& ring = *rings[source];
+        while (ring.depth() >= ring.capacity()) {
+            std::this_thread::yield();
+        }
+        ring.push(data, length, timestamp);
+    }
+
+    // Run the analyzers on a frame of a source from the calling thread
+    unsigned handlePacket(size_t source, pcpp::RawPacket* rawPacket) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        hostManager.setIngress(sources[source]);
+        unsigned errors = analyze(rawPacket);
+        packets.fetch_add(1, std::memory_order_relaxed);
+        this->errors.fetch_add(errors, std::memory_order_relaxed);
+        auto now = std::chrono::steady_clock::now();
+        expireIfDue(now);
+        publishIfDue(now);
+        return errors;
+    }
+
+    // Writer side: run a function on the host shard, serialized with the analysis of frames
+    template <typename Function>
+    void withHosts(Function&& function) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        function(hostManager);
+    }
+
+    /**
+     * @brief Reader side: last published snapshot of the hosts of the shard, never waiting on the writer.
+     *
+     * @param fresh Have the writer publish the pending changes at the end of its current batch,
+     *        or on its next idle poll, rather than within SnapshotInterval.
+     * @return The last published snapshot, never null.
+     */
+    std::shared_ptr<const HostSnapshot> getSnapshot(bool fresh = true) {
+        if (fresh) {
+            snapshotRequested.store(true, std::memory_order_release);
+        }
+        return hostManager.getSnapshot();
+    }
+
+    // Writer side: publish the pending changes now, once no analysis thread publishes them any more
+    void flush() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        publish(std::chrono::steady_clock::now());
+    }
+
+    // Reader side: every update of the shard numbered up to it is in the published snapshot
+    uint64_t getPublishedSequence() const {
+        return hostManager.getPublishedSequence();
+    }
+
+    // Interests declared by the analyzers of this worker
+    std::vector<AnalyzerInterests> getInterests() const {
+        std::vector<AnalyzerInterests> interests;
+        for (const std::unique_ptr<Analyzer>& analyzer : analyzers) {
+            interests.push_back(analyzer->getInterests());
+        }
+        return interests;
+    }
+
+    // Counters of the worker, the queue ones are summed over the rings of all sources
+    Stats getStats() const {
+        PacketRing::Stats queue{};
+        for (const std::unique_ptr<PacketRing>& ring : rings) {
+            PacketRing::Stats ringStats = ring->getStats();
+            queue.capacity += ringStats.capacity;
+            queue.depth += ringStats.depth;
+            queue.highWatermark = std::max(queue.highWatermark, ringStats.highWatermark);
+            queue.enqueued += ringStats.enqueued;
+            queue.dequeued += ringStats.dequeued;
+            queue.overflows += ringStats.overflows;
+        }
+        return {id, packets.load(std::memory_order_relaxed), errors.load(std::memory_order_relaxed),
+                unmatched.load(std::memory_order_relaxed), std::chrono::nanoseconds(busyNs.load(std::memory_order_relaxed)), queue,
+                hostManager.getAgingStats(), hostManager.getMemoryStats()};
+    }
+
+  private:
+    // Frames analyzed per acquisition of the writer mutex
+    static constexpr unsigned BatchSize = 64;
+    // Longest time the published snapshot lags behind the changes of the shard
+    static constexpr std::chrono::milliseconds SnapshotInterval{100};
+    // Resolution of the aging of the hosts
+    static constexpr std::chrono::seconds ExpiryInterval{1};
+
+    // Writer side: publish the changes of the shard and reset the publication deadline
+    std::shared_ptr<const HostSnapshot> publish(std::chrono::steady_clock::time_point now) {
+        snapshotRequested.store(false, std::memory_order_relaxed);
+        lastPublish = now;
+        return hostManager.publishSnapshot();
+    }
+
+    // Writer side: publish when a reader asked for it or the snapshot is older than SnapshotInterval
+    void publishIfDue(std::chrono::steady_clock::time_point now) {
+        if (!hostManager.hasChanges()) {
+            return;
+        }
+        if (snapshotRequested.load(std::memory_order_acquire) || now - lastPublish >= SnapshotInterval) {
+            publish(now);
+        }
+    }
+
+    // Writer side: age the hosts out to the current realtime second, once per ExpiryInterval
+    void expireIfDue(std::chrono::steady_clock::time_point now) {
+        if (now - lastExpiry < ExpiryInterval) {
+            return;
+        }
+        lastExpiry = now;
+        timespec realtime;
+        clock_gettime(CLOCK_REALTIME, &realtime);
+        hostManager.expireHosts(realtime.tv_sec);
+    }
+
+    // Analysis thread: drain the rings by batches and run the analyzers on each frame
+    void run() {
+        unsigned idlePolls = 0;
+        while (true) {
+            // Acquire the state before looking at the rings, so no frame queued before stop() is missed
+            bool stopping = !running.load(std::memory_order_acquire);
+            auto start = std::chrono::steady_clock::now();
+            unsigned batch = 0;
+            unsigned batchErrors = 0;
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                for (size_t source = 0; source < rings.size(); source++) {
+                    PacketRing& ring = *rings[source];
+                    if (ring.front() == nullptr) {
+                        continue;
+                    }
+                    hostManager.setIngress(sources[source]);
+                    const PacketRing::Slot* slot;
+                    unsigned sourceBatch = 0;
+                    while (sourceBatch < BatchSize && (slot = ring.front()) != nullptr) {
+                        // Analyze the frame in place, the slot is released afterwards
+                        pcpp::RawPacket rawPacket(slot->data, slot->length, slot->timestamp, false);
+                        batchErrors += analyze(&rawPacket);
+                        ring.pop();
+                        sourceBatch++;
+                    }
+                    batch += sourceBatch;
+                }
+                auto now = std::chrono::steady_clock::now();
+                expireIfDue(now);
+                publishIfDue(now);
+            }
+
+            if (batch == 0) {
+                if (stopping) {
+                    // Capture stopped and the last queued frames are processed, publish them
+                    std::lock_guard<std::mutex> lock(writerMutex);
+                    publish(std::chrono::steady_clock::now());
+                    break;
+                }
+                // Spin a little, then back off while the rings stay empty
+                if (++idlePolls < 64) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                continue;
+            }
+            idlePolls = 0;
+
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            busyNs.fetch_add(elapsed.count(), std::memory_order_relaxed);
+            packets.fetch_add(batch, std::memory_order_relaxed);
+            errors.fetch_add(batchErrors, std::memory_order_relaxed);
+        }
+    }
+
+    // Distribute the packet to the matching analyzers, returns the number of analyzers that rejected it
+    unsigned analyze(pcpp::RawPacket* rawPacket) {
+        FrameView frame(*rawPacket);
+        DispatchTable::Mask matches = dispatch.lookup(classifyFrame(frame));
+        if (matches == 0) {
+            unmatched.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        // Parse the raw packet once, down to the deepest layer the matching analyzers need
+        std::optional<pcpp::Packet> parsedPacket;
+        DispatchTable::Mask packetMatches = matches & ~frameAnalyzers;
+        if (packetMatches != 0) {
+            pcpp::OsiModelLayer depth = pcpp::OsiModelPhysicalLayer;
+            for (; packetMatches != 0; packetMatches &= packetMatches - 1) {
+                depth = std::max(depth, parseDepths[__builtin_ctzll(packetMatches)]);
+            }
+            parsedPacket.emplace(rawPacket, false, pcpp::UnknownProtocol, depth);
+        }
+
+        unsigned rejected = 0;
+        for (; matches != 0; matches &= matches - 1) {
+            size_t index = __builtin_ctzll(matches);
+            // Layers throw on truncated or malformed PDUs, skip the packet for this analyzer
+            try {
+                if (frameAnalyzers & (DispatchTable::Mask(1) << index)) {
+                    analyzers[index]->analyzeFrame(frame);
+                } else {
+                    analyzers[index]->analyzePacket(*parsedPacket);
+                }
+            } catch (const std::exception&) {
+                rejected++;
+            }
+        }
+        scratch.reset();
+        return rejected;
+    }
+
+    const size_t id;
+    // Name of each capture source, pinned as every observation is stamped with it, and its ring, indexed alike
+    std::vector<InternedString> sources;
+    std::vector<std::unique_ptr<PacketRing>> rings;
+    HostManager hostManager;
+    // Parser temporaries of the frame being analyzed
+    PacketArena scratch;
+    std::vector<std::unique_ptr<Analyzer>> analyzers;
+    DispatchTable dispatch;
+    // Analyzers on the FrameView fast path, and the parse depth of each analyzer
+    DispatchTable::Mask frameAnalyzers = 0;
+    std::vector<pcpp::OsiModelLayer> parseDepths;
+    // Serializes the writers of the shard, and the published snapshot state
+    std::mutex writerMutex;
+    std::atomic<bool> snapshotRequested{false};
+    std::chrono::steady_clock::time_point lastPublish{};
+    std::chrono::steady_clock::time_point lastExpiry{};
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> unmatched{0};
+    std::atomic<uint64_t> busyNs{0};
+};
+
+#endif // ANALYSIS_WORKER_HPP
@@ -0,0 +1,78 @@
+#include "CaptureFilter.hpp"
+
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+namespace {
+
+std::string hex(unsigned value, int width) {
+    std::ostringstream oss;
+    oss << "0x" << std::hex << std::setw(width) << std::setfill('0') << value;
+    return oss.str();
+}
+
+// Join the terms with "or", parenthesized so the result can be embedded
+std::string anyOf(const std::vector<std::string>& terms) {
+    std::string expression;
+    for (const std::string& term : terms) {
+        expression += expression.empty() ? "(" : " or ";
+        expression += term;
+    }
+    return expression.empty() ? expression : expression + ")";
+}
+
+} // namespace
+
+std::string buildCaptureFilter(const std::vector<AnalyzerInterests>& interests) {
+    std::set<uint16_t> etherTypes, udpPorts, snapPids;
+    std::set<uint8_t> llcSaps;
+    std::set<std::string> dstMacs;
+    for (const AnalyzerInterests& interest : interests) {
+        etherTypes.insert(interest.etherTypes.begin(), interest.etherTypes.end());
+        udpPorts.insert(interest.udpPorts.begin(), interest.udpPorts.end());
+        llcSaps.insert(interest.llcSaps.begin(), interest.llcSaps.end());
+        snapPids.insert(interest.snapPids.begin(), interest.snapPids.end());
+        for (const pcpp::MacAddress& mac : interest.dstMacs) {
+            dstMacs.insert(mac.toString());
+        }
+    }
+
+    // Keys that libpcap knows how to match behind a VLAN tag
+    std::vector<std::string> l3Terms;
+    for (uint16_t etherType : etherTypes) {
+        l3Terms.push_back("ether proto " + hex(etherType, 4));
+    }
+    for (uint16_t port : udpPorts) {
+        l3Terms.push_back("udp port " + std::to_string(port));
+    }
+
+    // 802.3 keys at fixed offsets, the tagged variant is shifted by the 4 bytes of the tag
+    std::vector<std::string> terms;
+    for (int tag = 0; tag <= 4; tag += 4) {
+        std::string dot3 = tag ? "ether[12:2] = 0x8100 and ether[16:2] <= 1500" : "ether[12:2] <= 1500";
+        for (uint8_t sap : llcSaps) {
+            terms.push_back("(" + dot3 + " and ether[" + std::to_string(14 + tag) + "] = " + hex(sap, 2) + ")");
+        }
+        for (uint16_t pid : snapPids) {
+            terms.push_back("(" + dot3 + " and ether[" + std::to_string(14 + tag) + ":2] = 0xaaaa and ether["
+                            + std::to_string(20 + tag) + ":2] = " + hex(pid, 4) + ")");
+        }
+    }
+    for (const std::string& mac : dstMacs) {
+        terms.push_back("ether dst " + mac);
+    }
+
+    // The vlan keyword shifts the offsets of everything after it, so it must come last
+    if (!l3Terms.empty()) {
+        terms.insert(terms.begin(), l3Terms.begin(), l3Terms.end());
+        terms.push_back("(vlan and " + anyOf(l3Terms) + ")");
+    }
+
+    std::string expression;
+    for (const std::string& term : terms) {
+        expression += expression.empty() ? "" : " or ";
+        expression += term;
+    }
+    return expression;
+}
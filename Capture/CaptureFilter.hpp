@@ -0,0 +1,22 @@
+#ifndef CAPTURE_FILTER_HPP
+#define CAPTURE_FILTER_HPP
+
+#include "../Analyzers/Analyzer.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Builds a BPF filter expression accepting the union of the analyzers' interests.
+ *
+ * Ethertype and UDP port keys are matched both on untagged and on 802.1Q tagged frames.
+ * LLC SAP and SNAP PID keys only apply to 802.3 frames (length field <= 1500) and are
+ * matched at their fixed offsets, tagged or not. Destination MAC keys are matched as is.
+ * Duplicate keys across analyzers are emitted once.
+ *
+ * @param interests The interests declared by every registered analyzer.
+ * @return The filter expression, or an empty string if no analyzer declared any key.
+ */
+std::string buildCaptureFilter(const std::vector<AnalyzerInterests>& interests);
+
+#endif // CAPTURE_FILTER_HPP
@@ -0,0 +1,92 @@
+#include "FrameClassifier.hpp"
+
+#include <stdexcept>
+
+namespace {
+
+uint64_t read48(const uint8_t* data) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 6; i++) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+template <typename Key>
+DispatchTable::Mask find(const std::unordered_map<Key, DispatchTable::Mask>& table, Key key) {
+    auto it = table.find(key);
+    return it != table.end() ? it->second : 0;
+}
+
+} // namespace
+
+FrameClass classifyFrame(const FrameView& frame) {
+    FrameClass keys;
+    if (!frame.hasEthernet()) {
+        return keys;
+    }
+    keys.dstMac = read48(frame.getData());
+    keys.vlanTags = static_cast<uint8_t>(frame.getVlanCount());
+    keys.etherType = frame.getEtherType();
+
+    if (frame.hasLlc()) {
+        keys.llc = true;
+        keys.llcSap = frame.getDsap();
+    }
+    if (frame.hasSnap()) {
+        keys.snap = true;
+        keys.snapPid = frame.getSnapPid();
+    }
+    if (frame.hasIPv4() || frame.hasIPv6()) {
+        keys.ipProtocol = frame.getIpProtocol();
+    }
+    if (frame.hasUdp()) {
+        keys.srcPort = frame.getSrcPort();
+        keys.dstPort = frame.getDstPort();
+    }
+    return keys;
+}
+
+void DispatchTable::add(size_t analyzer, const AnalyzerInterests& interests) {
+    if (analyzer >= MaxAnalyzers) {
+        throw std::length_error("DispatchTable: too many analyzers");
+    }
+    Mask bit = Mask(1) << analyzer;
+    for (uint16_t etherType : interests.etherTypes) {
+        etherTypes[etherType] |= bit;
+    }
+    for (uint16_t port : interests.udpPorts) {
+        udpPorts[port] |= bit;
+    }
+    for (uint8_t sap : interests.llcSaps) {
+        llcSaps[sap] |= bit;
+    }
+    for (uint16_t pid : interests.snapPids) {
+        snapPids[pid] |= bit;
+    }
+    for (const pcpp::MacAddress& mac : interests.dstMacs) {
+        uint8_t bytes[6];
+        mac.copyTo(bytes);
+        dstMacs[read48(bytes)] |= bit;
+    }
+}
+
+DispatchTable::Mask DispatchTable::lookup(const FrameClass& frame) const {
+    Mask mask = 0;
+    if (frame.etherType != 0) {
+        mask |= find(etherTypes, frame.etherType);
+    }
+    if (frame.llc) {
+        mask |= llcSaps[frame.llcSap];
+    }
+    if (frame.snap) {
+        mask |= find(snapPids, frame.snapPid);
+    }
+    if (frame.srcPort != 0 || frame.dstPort != 0) {
+        mask |= find(udpPorts, frame.srcPort) | find(udpPorts, frame.dstPort);
+    }
+    if (!dstMacs.empty()) {
+        mask |= find(dstMacs, frame.dstMac);
+    }
+    return mask;
+}
@@ -0,0 +1,72 @@
+#ifndef FRAME_CLASSIFIER_HPP
+#define FRAME_CLASSIFIER_HPP
+
+#include "../Analyzers/Analyzer.hpp"
+#include "../Layers/Frame/FrameView.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * @struct FrameClass
+ * @brief Match keys of a frame, decoded from its headers in a single pass.
+ */
+struct FrameClass {
+    // Ethernet II ethertype after the VLAN tags, 0 for 802.3 frames
+    uint16_t etherType = 0;
+    // Number of 802.1Q / 802.1ad tags skipped
+    uint8_t vlanTags = 0;
+    // 802.2 LLC destination SAP of 802.3 frames
+    bool llc = false;
+    uint8_t llcSap = 0;
+    // SNAP protocol ID of 802.3 LLC/SNAP frames
+    bool snap = false;
+    uint16_t snapPid = 0;
+    // IPv4 protocol or IPv6 next header, 0 if the frame is not IP
+    uint8_t ipProtocol = 0;
+    // UDP ports, 0 if the frame is not an unfragmented UDP datagram
+    uint16_t srcPort = 0;
+    uint16_t dstPort = 0;
+    // Destination MAC address packed in 48 bits
+    uint64_t dstMac = 0;
+};
+
+/**
+ * @brief Collects the match keys of a frame from its decoded headers.
+ *
+ * @param frame The view over the frame, whose headers are located once.
+ * @return The match keys found in the frame, fewer of them if it is truncated.
+ */
+FrameClass classifyFrame(const FrameView& frame);
+
+/**
+ * @class DispatchTable
+ *
+ * @brief Maps the match keys of a frame to the analyzers interested in it.
+ *
+ * Every analyzer registers its AnalyzerInterests under its index at startup. The table keeps,
+ * for each key, the bitmask of the analyzers that declared it, so looking a frame up costs
+ * a constant number of hash probes whatever the number of analyzers.
+ */
+class DispatchTable {
+  public:
+    // One bit per analyzer index
+    using Mask = uint64_t;
+    static constexpr size_t MaxAnalyzers = 64;
+
+    // Register the interests of the analyzer at the given index, throws past MaxAnalyzers
+    void add(size_t analyzer, const AnalyzerInterests& interests);
+    // Analyzers interested in a frame, 0 if none
+    Mask lookup(const FrameClass& frame) const;
+
+  private:
+    std::unordered_map<uint16_t, Mask> etherTypes;
+    std::unordered_map<uint16_t, Mask> udpPorts;
+    std::unordered_map<uint16_t, Mask> snapPids;
+    std::unordered_map<uint64_t, Mask> dstMacs;
+    std::array<Mask, 256> llcSaps{};
+};
+
+#endif // FRAME_CLASSIFIER_HPP
@@ -0,0 +1,136 @@
+#ifndef PACKET_RING_HPP
+#define PACKET_RING_HPP
+
+#include "RawPacket.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+/**
+ * @class PacketRing
+ *
+ * @brief Preallocated single-producer/single-consumer ring of raw frames.
+ *
+ * The PacketRing class decouples the libpcap capture thread from the analysis thread.
+ * The producer copies each frame (truncated to MaxFrameSize) and its timestamp into the
+ * next free slot, the consumer peeks at the oldest slot, analyzes it in place and releases it.
+ * No allocation nor lock is taken after construction: the read and write indexes are atomics
+ * living on separate cache lines, and each side keeps a cached copy of the other side's index
+ * so that the shared cache line is only touched when the ring looks full or empty.
+ *
+ * When the ring is full the frame is dropped and counted as an overflow, so backpressure is
+ * visible through getStats() instead of being hidden in the kernel buffer.
+ */
+class PacketRing {
+  public:
+    // Bytes kept per frame, the discovery protocols we analyze fit well below this
+    static constexpr size_t MaxFrameSize = 2048;
+
+    struct Slot {
+        timespec timestamp;
+        uint32_t length;
+        uint32_t frameLength;
+        uint8_t data[MaxFrameSize];
+    };
+
+    struct Stats {
+        size_t capacity;
+        size_t depth;
+        size_t highWatermark;
+        uint64_t enqueued;
+        uint64_t dequeued;
+        uint64_t overflows;
+    };
+
+    // Capacity is rounded up to the next power of two
+    explicit PacketRing(size_t capacity = 4096) : mask(roundUpPow2(capacity) - 1), slots(mask + 1) {}
+
+    PacketRing(const PacketRing&) = delete;
+    PacketRing& operator=(const PacketRing&) = delete;
+
+    // Producer side: copy a frame into the ring, returns false if the ring is full
+    bool push(const pcpp::RawPacket& packet) {
+        return push(packet.getRawData(), packet.getRawDataLen(), packet.getPacketTimeStamp());
+    }
+
+    bool push(const uint8_t* data, size_t length, const timespec& timestamp) {
+        const size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedReadIndex > mask) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            if (head - cachedReadIndex > mask) {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        Slot& slot = slots[head & mask];
+        slot.timestamp = timestamp;
+        slot.frameLength = static_cast<uint32_t>(length);
+        slot.length = static_cast<uint32_t>(length < MaxFrameSize ? length : MaxFrameSize);
+        std::memcpy(slot.data, data, slot.length);
+
+        const size_t depth = head + 1 - cachedReadIndex;
+        if (depth > highWatermark.load(std::memory_order_relaxed)) {
+            highWatermark.store(depth, std::memory_order_relaxed);
+        }
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: oldest slot, or nullptr if the ring is empty
+    const Slot* front() {
+        const size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == cachedWriteIndex) {
+            cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+            if (tail == cachedWriteIndex) {
+                return nullptr;
+            }
+        }
+        return &slots[tail & mask];
+    }
+
+    // Consumer side: release the slot returned by front()
+    void pop() {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    size_t depth() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+    Stats getStats() const {
+        const size_t tail = readIndex.load(std::memory_order_acquire);
+        const size_t head = writeIndex.load(std::memory_order_acquire);
+        return {capacity(), head - tail, highWatermark.load(std::memory_order_relaxed), head, tail,
+                overflows.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    static size_t roundUpPow2(size_t value) {
+        size_t pow2 = 1;
+        while (pow2 < value) {
+            pow2 <<= 1;
+        }
+        return pow2;
+    }
+
+    const size_t mask;
+    std::vector<Slot> slots;
+
+    // Written by the producer only
+    alignas(64) std::atomic<size_t> writeIndex{0};
+    size_t cachedReadIndex = 0;
+    std::atomic<size_t> highWatermark{0};
+    std::atomic<uint64_t> overflows{0};
+
+    // Written by the consumer only
+    alignas(64) std::atomic<size_t> readIndex{0};
+    size_t cachedWriteIndex = 0;
+};
+
+#endif // PACKET_RING_HPP
@@ -0,0 +1,209 @@
+#include "TPacketCapture.hpp"
+
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <poll.h>
+#include <pcap.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+TPacketCapture::TPacketCapture(const std::string& interface, const Config& config)
+    : interface(interface), config(config) {}
+
+TPacketCapture::~TPacketCapture() {
+    stopCapture();
+    close();
+}
+
+bool TPacketCapture::open() {
+    // No protocol yet: frames are only queued once the socket is bound, after the filter is attached
+    fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (fd < 0) {
+        std::cerr << "Error: Unable to create the AF_PACKET socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    int version = TPACKET_V3;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        std::cerr << "Error: TPACKET_V3 is not supported: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    tpacket_req3 request{};
+    request.tp_block_size = config.blockSize;
+    request.tp_block_nr = config.blockCount;
+    request.tp_frame_size = config.frameSize;
+    request.tp_frame_nr = (config.blockSize / config.frameSize) * config.blockCount;
+    request.tp_retire_blk_tov = config.blockTimeoutMs;
+    if (setsockopt(fd, SOL_PACKET, PACKET_RX_RING, &request, sizeof(request)) < 0) {
+        std::cerr << "Error: Unable to set up the RX ring: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    ringSize = static_cast<size_t>(config.blockSize) * config.blockCount;
+    void* map = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        std::cerr << "Error: Unable to map the RX ring: " << strerror(errno) << std::endl;
+        ringSize = 0;
+        close();
+        return false;
+    }
+    ring = static_cast<uint8_t*>(map);
+
+    int ifIndex = if_nametoindex(interface.c_str());
+    if (ifIndex == 0) {
+        std::cerr << "Error: Unable to find the interface: " << interface << std::endl;
+        close();
+        return false;
+    }
+
+    packet_mreq membership{};
+    membership.mr_ifindex = ifIndex;
+    membership.mr_type = PACKET_MR_PROMISC;
+    if (setsockopt(fd, SOL_PACKET, PACKET_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+        std::cerr << "Warning: Unable to enable promiscuous mode on " << interface << ": " << strerror(errno) << std::endl;
+    }
+
+    if (!filter.empty()) {
+        sock_fprog program{};
+        program.len = static_cast<unsigned short>(filter.size());
+        program.filter = filter.data();
+        if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0) {
+            std::cerr << "Error: Unable to attach the capture filter, capturing everything: " << strerror(errno) << std::endl;
+        }
+    }
+
+    sockaddr_ll address{};
+    address.sll_family = AF_PACKET;
+    address.sll_protocol = htons(ETH_P_ALL);
+    address.sll_ifindex = ifIndex;
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "Error: Unable to bind to " << interface << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    if (config.fanoutGroup != 0) {
+        uint32_t mode = PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG;
+        if (config.fanoutMode == FanoutMode::Cpu) {
+            mode = PACKET_FANOUT_CPU;
+        } else if (config.fanoutMode == FanoutMode::Rollover) {
+            mode = PACKET_FANOUT_ROLLOVER;
+        }
+        uint32_t fanout = config.fanoutGroup | (mode << 16);
+        if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0) {
+            std::cerr << "Error: Unable to join the fanout group " << config.fanoutGroup << ": " << strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TPacketCapture::setFilter(const std::string& expression) {
+    pcap_t* handle = pcap_open_dead(DLT_EN10MB, 0xffff);
+    if (handle == nullptr) {
+        return false;
+    }
+
+    bpf_program program;
+    if (pcap_compile(handle, &program, expression.c_str(), 1, PCAP_NETMASK_UNKNOWN) < 0) {
+        std::cerr << "Error: Unable to compile the capture filter: " << pcap_geterr(handle) << std::endl;
+        pcap_close(handle);
+        return false;
+    }
+
+    // libpcap instructions have the layout of the kernel ones
+    const sock_filter* instructions = reinterpret_cast<const sock_filter*>(program.bf_insns);
+    filter.assign(instructions, instructions + program.bf_len);
+
+    pcap_freecode(&program);
+    pcap_close(handle);
+    return true;
+}
+
+void TPacketCapture::startCapture(FrameHandler frameHandler) {
+    handler = std::move(frameHandler);
+    running = true;
+    thread = std::thread(&TPacketCapture::run, this);
+}
+
+void TPacketCapture::stopCapture() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void TPacketCapture::close() {
+    if (ring != nullptr) {
+        munmap(ring, ringSize);
+        ring = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+TPacketCapture::Stats TPacketCapture::getStats() {
+    // The kernel resets its counters on every read, accumulate them
+    if (fd >= 0) {
+        tpacket_stats_v3 stats{};
+        socklen_t length = sizeof(stats);
+        if (getsockopt(fd, SOL_PACKET, PACKET_STATISTICS, &stats, &length) == 0) {
+            kernelPackets += stats.tp_packets;
+            kernelDrops += stats.tp_drops;
+            kernelFreezes += stats.tp_freeze_q_cnt;
+        }
+    }
+    return {kernelPackets.load(), kernelDrops.load(), kernelFreezes.load(), blocks.load(), frames.load()};
+}
+
+void TPacketCapture::run() {
+    uint32_t current = 0;
+    pollfd pfd{fd, POLLIN | POLLERR, 0};
+
+    while (running.load(std::memory_order_relaxed)) {
+        uint8_t* block = ring + static_cast<size_t>(current) * config.blockSize;
+        tpacket_block_desc* descriptor = reinterpret_cast<tpacket_block_desc*>(block);
+
+        // Wait for the kernel to retire the block
+        if ((__atomic_load_n(&descriptor->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            poll(&pfd, 1, 100);
+            continue;
+        }
+
+        walkBlock(block);
+
+        // Every frame of the block is handled, give it back to the kernel
+        __atomic_store_n(&descriptor->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        current = (current + 1) % config.blockCount;
+    }
+}
+
+void TPacketCapture::walkBlock(uint8_t* block) {
+    tpacket_block_desc* descriptor = reinterpret_cast<tpacket_block_desc*>(block);
+    uint32_t count = descriptor->hdr.bh1.num_pkts;
+    uint8_t* cursor = block + descriptor->hdr.bh1.offset_to_first_pkt;
+
+    for (uint32_t i = 0; i < count; i++) {
+        tpacket3_hdr* header = reinterpret_cast<tpacket3_hdr*>(cursor);
+        timespec timestamp{static_cast<time_t>(header->tp_sec), static_cast<long>(header->tp_nsec)};
+        handler(cursor + header->tp_mac, header->tp_snaplen, timestamp);
+        cursor += header->tp_next_offset;
+    }
+
+    blocks.fetch_add(1, std::memory_order_relaxed);
+    frames.fetch_add(count, std::memory_order_relaxed);
+}
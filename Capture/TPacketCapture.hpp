@@ -0,0 +1,112 @@
+#ifndef TPACKET_CAPTURE_HPP
+#define TPACKET_CAPTURE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <linux/filter.h>
+
+/**
+ * @class TPacketCapture
+ *
+ * @brief AF_PACKET capture backend reading a TPACKET_V3 memory-mapped RX ring.
+ *
+ * The kernel fills fixed-size blocks of the ring with frames and retires a block once it is
+ * full or its timeout expires. The capture thread walks every retired block as a batch and
+ * hands each frame to the handler straight from the mapped memory, without any copy nor
+ * system call per frame. A block is given back to the kernel only once all of its frames
+ * have been handled, so the handler may use the frame data in place.
+ *
+ * Frames are delivered without their 802.1Q tag, which the kernel strips into the frame
+ * metadata; untagged filter terms therefore match tagged traffic as well.
+ *
+ * Several TPacketCapture on the same interface can join one PACKET_FANOUT group, the kernel
+ * then spreads the frames across their rings (by flow hash, receiving CPU or rollover when a
+ * ring is full) and each socket keeps its own capture thread and counters.
+ */
+class TPacketCapture {
+  public:
+    // How the kernel spreads frames across the sockets of a fanout group
+    enum class FanoutMode {
+        Hash,
+        Cpu,
+        Rollover
+    };
+
+    struct Config {
+        // Bytes per block, must be a multiple of the page size
+        uint32_t blockSize = 1 << 22;
+        // Number of blocks in the ring
+        uint32_t blockCount = 64;
+        // Nominal frame size the kernel validates the ring geometry with; TPACKET_V3 packs frames
+        // of any length back to back in a block, only a frame longer than a block is cut
+        uint32_t frameSize = 2048;
+        // Milliseconds before the kernel retires a partially filled block
+        uint32_t blockTimeoutMs = 64;
+        // PACKET_FANOUT group to join, 0 for a standalone socket
+        uint16_t fanoutGroup = 0;
+        FanoutMode fanoutMode = FanoutMode::Hash;
+    };
+
+    struct Stats {
+        uint64_t packets;
+        uint64_t drops;
+        uint64_t freezes;
+        uint64_t blocks;
+        uint64_t frames;
+    };
+
+    // Called for every frame, the data is only valid during the call
+    using FrameHandler = std::function<void(const uint8_t* data, size_t length, const timespec& timestamp)>;
+
+    TPacketCapture(const std::string& interface, const Config& config);
+    ~TPacketCapture();
+
+    TPacketCapture(const TPacketCapture&) = delete;
+    TPacketCapture& operator=(const TPacketCapture&) = delete;
+
+    // Compile a libpcap filter expression, attached by open(); to be called before it
+    bool setFilter(const std::string& expression);
+    // Create the socket, set up and map the ring, attach the filter, bind to the interface in
+    // promiscuous mode and join the fanout group if one is configured. The socket receives
+    // nothing before it is bound, so no unfiltered frame reaches the ring.
+    bool open();
+    // Start the capture thread
+    void startCapture(FrameHandler handler);
+    // Stop the capture thread, the block being walked is finished first
+    void stopCapture();
+    // Unmap the ring and close the socket
+    void close();
+
+    // Kernel counters (accepted, dropped, ring freezes) and blocks/frames walked so far
+    Stats getStats();
+    const std::string& getName() const { return interface; }
+
+  private:
+    void run();
+    void walkBlock(uint8_t* block);
+
+    std::string interface;
+    Config config;
+    // Kernel instructions of the filter set, empty for none
+    std::vector<sock_filter> filter;
+    int fd = -1;
+    uint8_t* ring = nullptr;
+    size_t ringSize = 0;
+
+    FrameHandler handler;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    std::atomic<uint64_t> kernelPackets{0};
+    std::atomic<uint64_t> kernelDrops{0};
+    std::atomic<uint64_t> kernelFreezes{0};
+    std::atomic<uint64_t> blocks{0};
+    std::atomic<uint64_t> frames{0};
+};
+
+#endif // TPACKET_CAPTURE_HPP
@@ -1,71 +1,689 @@
 #include "Analyzers/Analyzer.hpp"
+#include "Capture/AnalysisWorker.hpp"
+#include "Capture/CaptureFilter.hpp"
+#include "Capture/PacketRing.hpp"
+#include "Capture/TPacketCapture.hpp"
+#include "Hosts/HostDumper.hpp"
+#include "Hosts/ObservationLog.hpp"
+#include "Hosts/SnapshotFile.hpp"
+#include "PcapFileDevice.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+// Live capture backends of the CaptureManager
+enum class CaptureBackend {
+    Pcap,
+    TPacketV3
+};
 
 // CaptureManager class
 /**
  * @class CaptureManager
  * @brief Manages packet capture and distribution to analyzers.
- * 
- * The CaptureManager class is responsible for managing packet capture on a network interface
- * and distributing captured packets to a list of analyzers. It provides methods to start and
- * stop packet capture, add analyzers to the list, and handle packet distribution to the analyzers.
+ *
+ * The CaptureManager class is responsible for managing packet capture on one or several network
+ * interfaces and distributing captured packets to a list of analyzers. It provides methods to start
+ * and stop packet capture, add analyzers to the list, and handle packet distribution to the analyzers.
+ *
+ * Every interface is a capture source with its own capture thread, and all of them feed the same
+ * host store; each observation is tagged with the interface it was captured on.
+ *
+ * Live capture is split in two stages: the libpcap callback only copies the frame into the
+ * PacketRing of one AnalysisWorker, and the worker threads drain their rings and run the
+ * analyzers, so a slow analyzer shows up as queue depth and overflows instead of silent
+ * kernel drops. Frames are sharded by host MAC address, each worker owning its own
+ * HostManager shard and analyzer set; the merged host view is assembled on demand.
+ *
+ * Unless a filter is set explicitly, the union of the analyzers' interests is compiled into
+ * a BPF filter attached to the device, so uninteresting traffic is dropped in the kernel.
+ *
+ * Two live capture backends are available: libpcap through PcapPlusPlus (the default), and
+ * a TPACKET_V3 memory-mapped ring read by TPacketCapture. With the latter, frames are analyzed
+ * in place by the capture thread, block by block, and never copied. Several TPACKET_V3 sockets
+ * can be opened on each interface and joined to one PACKET_FANOUT group, so the kernel spreads
+ * the load across their capture threads.
  */
 class CaptureManager {
 private:
-    pcpp::PcapLiveDevice *device;
-    std::vector<Analyzer*> analyzers;
+    /**
+     * @struct CaptureSource
+     * @brief One captured interface, with its libpcap device or its TPACKET_V3 sockets.
+     */
+    struct CaptureSource {
+        CaptureManager* manager;
+        size_t index;
+        std::string name;
+        pcpp::PcapLiveDevice* device;
+        pcpp::IPcapDevice::PcapStats kernelStats{};
+        std::vector<std::unique_ptr<TPacketCapture>> tpackets;
+    };
+
+    std::vector<std::unique_ptr<CaptureSource>> sources;
+    std::vector<AnalyzerFactory> analyzerFactories;
+
+    // Analysis workers, created on the first capture or replay
+    size_t workerCount = 1;
+    size_t queueCapacity = 4096;
+    size_t expectedHosts = 0;
+    std::vector<std::unique_ptr<AnalysisWorker>> workers;
+    std::chrono::steady_clock::time_point startTime;
+    // Sequence of the host updates, shared by the shards so it orders them all
+    std::shared_ptr<std::atomic<uint64_t>> hostSequence = std::make_shared<std::atomic<uint64_t>>(0);
+    // Snapshot file the host shards are loaded from when the workers are created
+    std::string warmStartFile;
+    // Write-ahead log of the observations since the last snapshot, replayed when the workers are created
+    std::unique_ptr<ObservationLog> observationLog;
+    // Lifetime of the observations, applied to the host shards when the workers are created
+    AgingPolicy agingPolicy;
+    // Serializes the snapshot writes and the observation log rotations that go with them
+    std::mutex snapshotMutex;
+
+    // Capture filter, built from the analyzers' interests unless set explicitly
+    std::string captureFilter;
+    bool customFilter = false;
+
+    // Live capture backend
+    CaptureBackend backend = CaptureBackend::Pcap;
+    TPacketCapture::Config tpacketConfig;
+    size_t tpacketSockets = 1;
+    bool capturing = false;
 
 public:
-    CaptureManager(const std::string &interface) {
-        // Find the network interface by IP address
-        device = pcpp::PcapLiveDeviceList::getInstance().getPcapLiveDeviceByName(interface);
-        if (device == NULL) {
-            std::cerr << "Error: Unable to find the device with IP: " << interface << std::endl;
-            exit(1);
+    /**
+     * @struct ReplayStats
+     * @brief Throughput figures measured while replaying a capture file.
+     */
+    struct ReplayStats {
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        uint64_t errors = 0;
+        std::chrono::nanoseconds elapsed{0};
+
+        double packetsPerSecond() const {
+            return elapsed.count() ? packets * 1e9 / elapsed.count() : 0.0;
+        }
+        double nsPerPacket() const {
+            return packets ? double(elapsed.count()) / packets : 0.0;
+        }
+    };
+
+    // Offline mode, packets are fed through replayFile()
+    CaptureManager() {}
+
+    CaptureManager(const std::string &interface) : CaptureManager(std::vector<std::string>{interface}) {}
+
+    // Capture several interfaces at once, each with its own capture thread
+    CaptureManager(const std::vector<std::string> &interfaces) {
+        for (const std::string& interface : interfaces) {
+            // Find the network interface by name
+            pcpp::PcapLiveDevice* device = pcpp::PcapLiveDeviceList::getInstance().getPcapLiveDeviceByName(interface);
+            if (device == NULL) {
+                std::cerr << "Error: Unable to find the device: " << interface << std::endl;
+                exit(1);
+            }
+            sources.push_back(std::unique_ptr<CaptureSource>(new CaptureSource{this, sources.size(), interface, device}));
         }
     }
 
+    // The capture sources point back to the manager
+    CaptureManager(const CaptureManager&) = delete;
+    CaptureManager& operator=(const CaptureManager&) = delete;
+
     // Destructor
     ~CaptureManager() {
     }
 
-    // Add an analyzer to the list
-    void addAnalyzer(Analyzer* analyzer) {
-        analyzers.push_back(analyzer);
+    // Add an analyzer, one instance is built for the host shard of every worker
+    template <typename AnalyzerType>
+    void addAnalyzer() {
+        analyzerFactories.push_back([](HostManager& hostManager) {
+            return std::unique_ptr<Analyzer>(new AnalyzerType(hostManager));
+        });
+    }
+
+    // Set the number of analysis threads, before the capture or replay starts
+    void setWorkerCount(size_t count) {
+        workerCount = count > 0 ? count : 1;
     }
 
-    // Start capturing packets
+    // Set the number of frames each worker queue can hold, before the capture or replay starts
+    void setQueueCapacity(size_t capacity) {
+        queueCapacity = capacity > 0 ? capacity : 1;
+    }
+
+    // Pre-size the host shards for the expected number of hosts, before the capture or replay starts
+    void setExpectedHosts(size_t hosts) {
+        expectedHosts = hosts;
+    }
+
+    // Replace the filter built from the analyzers' interests, an empty filter captures everything
+    void setCaptureFilter(const std::string& filter) {
+        captureFilter = filter;
+        customFilter = true;
+    }
+
+    /**
+     * @brief Selects the live capture backend, before startCapture().
+     *
+     * @param captureBackend The backend to capture with.
+     * @param config The ring geometry and fanout mode of the TPACKET_V3 sockets.
+     * @param sockets The number of TPACKET_V3 sockets opened per interface in one fanout group, each with its own capture thread.
+     */
+    void setCaptureBackend(CaptureBackend captureBackend, const TPacketCapture::Config& config = TPacketCapture::Config(), size_t sockets = 1) {
+        backend = captureBackend;
+        tpacketConfig = config;
+        tpacketSockets = sockets > 0 ? sockets : 1;
+    }
+
+    // Start capturing packets on every interface
     void startCapture() {
-        if (!device->open()) {
-            std::cerr << "Error: Unable to open the device for capturing" << std::endl;
-            exit(1);
+        capturing = true;
+        if (backend == CaptureBackend::TPacketV3) {
+            startTPacketCapture();
+            return;
         }
 
-        std::cout << "Starting packet capture on interface: " << device->getName() << std::endl;
+        for (auto& source : sources) {
+            if (!source->device->open()) {
+                std::cerr << "Error: Unable to open the device for capturing: " << source->name << std::endl;
+                exit(1);
+            }
+        }
 
-        // Start capturing, providing a callback function
-        device->startCapture(onPacketArrives, this);
+        // Start the analysis stage before any frame can be queued
+        createWorkers(queueCapacity);
+        for (auto& source : sources) {
+            std::cout << "Starting packet capture on interface: " << source->name << std::endl;
+            applyCaptureFilter(*source->device);
+        }
+        for (auto& worker : workers) {
+            worker->start();
+        }
+
+        // Start capturing, libpcap runs one capture thread per device
+        for (auto& source : sources) {
+            source->device->startCapture(onPacketArrives, source.get());
+        }
     }
 
     // Stop capturing packets
     void stopCapture() {
-        device->stopCapture();
-        device->close();
+        if (!capturing) {
+            return;
+        }
+        capturing = false;
+        for (auto& source : sources) {
+            for (auto& tpacket : source->tpackets) {
+                tpacket->stopCapture();
+                tpacket->getStats();
+                tpacket->close();
+            }
+            if (source->device->isOpened()) {
+                source->device->stopCapture();
+                source->device->getStatistics(source->kernelStats);
+                source->device->close();
+            }
+        }
+
+        // The producers are gone, let the workers drain what is left and publish it
+        for (auto& worker : workers) {
+            worker->stop();
+            worker->flush();
+        }
+    }
+
+    // Print the kernel counters per interface and the per worker throughput and queue counters
+    void printCaptureStats() const {
+        for (const auto& source : sources) {
+            for (size_t i = 0; i < source->tpackets.size(); i++) {
+                TPacketCapture::Stats stats = source->tpackets[i]->getStats();
+                std::cout << source->name << " socket " << i << ": " << stats.packets << " packets accepted by the filter"
+                          << ", " << stats.drops << " dropped (ring full)"
+                          << ", " << stats.freezes << " ring freezes"
+                          << ", " << stats.blocks << " blocks walked"
+                          << ", " << (stats.blocks ? stats.frames / stats.blocks : 0) << " frames/block" << std::endl;
+            }
+            if (source->tpackets.empty()) {
+                pcpp::IPcapDevice::PcapStats stats = source->kernelStats;
+                if (source->device->isOpened()) {
+                    source->device->getStatistics(stats);
+                }
+                std::cout << source->name << ": " << stats.packetsRecv << " packets accepted by the filter"
+                          << ", " << stats.packetsDrop << " dropped (buffer full)"
+                          << ", " << stats.packetsDropByInterface << " dropped by the interface" << std::endl;
+            }
+        }
+        printWorkerStats();
+        if (observationLog) {
+            ObservationLog::Stats stats = observationLog->getStats();
+            std::cout << "Observation log: " << stats.records << " observations"
+                      << ", " << (stats.records ? stats.bytes / stats.records : 0) << " bytes/observation"
+                      << ", " << stats.commits << " commits"
+                      << ", " << stats.dropped << " dropped" << std::endl;
+        }
+    }
+
+    // Print the per worker throughput and queue counters
+    void printWorkerStats() const {
+        double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        for (const auto& worker : workers) {
+            AnalysisWorker::Stats stats = worker->getStats();
+            std::cout << "Worker " << stats.id << ": " << stats.packets << " packets"
+                      << ", " << static_cast<uint64_t>(uptime > 0 ? stats.packets / uptime : 0) << " packets/s"
+                      << ", " << (stats.packets ? stats.busy.count() / stats.packets : 0) << " ns/packet busy";
+            // No queue when the capture threads analyze inline
+            if (stats.queue.capacity != 0) {
+                std::cout << ", queue depth " << stats.queue.depth << "/" << stats.queue.capacity
+                          << ", high watermark " << stats.queue.highWatermark
+                          << ", overflows " << stats.queue.overflows;
+            }
+            std::cout << ", malformed " << stats.errors << ", unmatched " << stats.unmatched;
+            if (agingPolicy.enabled()) {
+                std::cout << ", expired " << stats.aging.expiredObservations << " observations"
+                          << ", evicted " << stats.aging.evictedHosts << " hosts"
+                          << ", " << stats.aging.scheduledTimers << " timers";
+            }
+            std::cout << ", host pool " << stats.memory.bytesInUse / 1024 << "/" << stats.memory.bytesReserved / 1024 << " KiB"
+                      << " in " << stats.memory.slabs << " slabs"
+                      << ", " << static_cast<int>(stats.memory.fragmentation() * 100) << "% free";
+            std::cout << std::endl;
+        }
+        StringInterner::Stats strings = StringInterner::global().getStats();
+        std::cout << "Interned strings: " << strings.strings << " strings, " << strings.bytes / 1024 << " KiB"
+                  << ", " << strings.references << " references"
+                  << ", dedup ratio " << static_cast<int>(strings.dedupRatio() * 10) / 10.0 << std::endl;
+    }
+
+    // Snapshot of the host shard of every worker, taken without blocking the analysis
+    HostSnapshots getHostSnapshots() {
+        HostSnapshots snapshots;
+        snapshots.completeSequence = hostSequence->load();
+        for (auto& worker : workers) {
+            snapshots.completeSequence = std::min(snapshots.completeSequence, worker->getPublishedSequence());
+        }
+        // Taken after the sequence numbers, so each snapshot is at least as recent as its number
+        for (auto& worker : workers) {
+            snapshots.shards.push_back(worker->getSnapshot());
+        }
+        return snapshots;
+    }
+
+    // Restore the hosts from a snapshot file when the workers are created, before any frame is analyzed
+    void setWarmStart(const std::string& path) {
+        warmStartFile = path;
+    }
+
+    // Age the observations and the hosts out, set before the workers are created
+    void setAgingPolicy(const AgingPolicy& policy) {
+        agingPolicy = policy;
+    }
+
+    // Log every accepted observation to a file, committed every interval, until the next snapshot
+    void setObservationLog(const std::string& path, std::chrono::milliseconds commitInterval) {
+        observationLog = std::make_unique<ObservationLog>(path, commitInterval);
+    }
+
+    /**
+     * @brief Writes the hosts of every shard to a binary snapshot file, replaced atomically.
+     *
+     * Each shard is encoded under its writer lock, so its analysis pauses for the encoding of
+     * its hosts only; the file is written once every lock is released. The observations
+     * logged before the snapshot are dropped from the observation log once it is written.
+     * Concurrent calls are serialized, so the log is never rotated under a snapshot in progress.
+     *
+     * @param path The snapshot file.
+     * @return true if the file was replaced.
+     */
+    bool writeSnapshot(const std::string& path) {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        if (workers.empty()) {
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        // Every observation logged so far is applied before its shard is locked below
+        bool rotated = observationLog && observationLog->rotate();
+        // Every update numbered up to it is complete before its shard is locked below
+        uint64_t sequence = hostSequence->load();
+        SnapshotFile::Encoder encoder;
+        for (auto& worker : workers) {
+            worker->withHosts([&encoder](HostManager& hostManager) {
+                hostManager.getHostMap().forEach([&encoder](const Host& host) {
+                    encoder.add(host);
+                });
+            });
+        }
+        size_t hosts = encoder.size();
+        std::string image = encoder.finish(sequence);
+        if (!SnapshotFile::write(path, image)) {
+            return false;
+        }
+        if (rotated) {
+            observationLog->dropRotated();
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Hosts snapshot written to " << path << ": " << hosts << " hosts, " << image.size() << " bytes in "
+                  << elapsed.count() / 1000.0 << " ms, sequence " << sequence << std::endl;
+        return true;
+    }
+
+    // Merge the host snapshots of all workers into one JSON array
+    Json::Value getHostsJson() {
+        Json::Value hostsJson(Json::arrayValue);
+        for (const auto& snapshot : getHostSnapshots().shards) {
+            snapshot->forEach([&hostsJson](uint64_t, const Json::Value& host) {
+                hostsJson.append(host);
+            });
+        }
+        return hostsJson;
     }
 
-    // Static callback for packet arrival
+    // Merge the hosts of all workers updated after the given sequence number
+    Json::Value getChangesSince(uint64_t sequence) {
+        Json::Value hostsJson(Json::arrayValue);
+        for (const auto& snapshot : getHostSnapshots().shards) {
+            for (const Json::Value& host : snapshot->changesSince(sequence)) {
+                hostsJson.append(host);
+            }
+        }
+        return hostsJson;
+    }
+
+    // Replace the report file with the merged hosts information, from the calling thread
+    void dumpHostsToFile(const std::string& filename) {
+        HostDumper::dump(filename, getHostSnapshots());
+    }
+
+    // Print the merged host map
+    void printHostMap() {
+        std::cout << getHostsJson() << std::endl;
+    }
+
+    /**
+     * @brief Replays a pcap or pcapng file through the analyzers as fast as possible.
+     *
+     * Packets are read one by one into a reused RawPacket, without honouring the capture
+     * timestamps. With a single worker they are analyzed inline by the reading thread, otherwise
+     * they are dispatched to the workers, waiting for room when a queue is full so nothing is
+     * lost. The reader is picked from the file extension by PcapPlusPlus. Throughput is printed
+     * once the end of the file is reached and every worker is drained.
+     *
+     * @param filename Path to the capture file.
+     * @return The replay statistics, with zero packets if the file could not be opened.
+     */
+    ReplayStats replayFile(const std::string &filename) {
+        ReplayStats stats;
+        std::unique_ptr<pcpp::IFileReaderDevice> reader(pcpp::IFileReaderDevice::getReader(filename));
+        if (reader == nullptr || !reader->open()) {
+            std::cerr << "Error: Unable to open the capture file: " << filename << std::endl;
+            return stats;
+        }
+
+        createWorkers({filename}, queueCapacity);
+        applyCaptureFilter(*reader);
+        bool inline_ = workers.size() == 1;
+        if (!inline_) {
+            for (auto& worker : workers) {
+                worker->start();
+            }
+        }
+
+        pcpp::RawPacket rawPacket;
+        auto start = std::chrono::steady_clock::now();
+        while (reader->getNextPacket(rawPacket)) {
+            stats.bytes += rawPacket.getRawDataLen();
+            if (inline_) {
+                stats.errors += workers.front()->handlePacket(0, &rawPacket);
+            } else {
+                selectWorker(rawPacket.getRawData(), rawPacket.getRawDataLen())
+                    .enqueueBlocking(0, rawPacket.getRawData(), rawPacket.getRawDataLen(), rawPacket.getPacketTimeStamp());
+            }
+            stats.packets++;
+        }
+        if (!inline_) {
+            for (auto& worker : workers) {
+                worker->stop();
+                stats.errors += worker->getStats().errors;
+            }
+        }
+        // No analysis thread runs any more, publish the last changes for the readers
+        for (auto& worker : workers) {
+            worker->flush();
+        }
+        stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        reader->close();
+
+        std::cout << "Replayed " << stats.packets << " packets (" << stats.bytes << " bytes) from " << filename
+                  << " in " << std::chrono::duration<double>(stats.elapsed).count() << " s: "
+                  << static_cast<uint64_t>(stats.packetsPerSecond()) << " packets/s, "
+                  << static_cast<uint64_t>(stats.nsPerPacket()) << " ns/packet, "
+                  << stats.errors << " malformed" << std::endl;
+        if (!inline_) {
+            printWorkerStats();
+        }
+        return stats;
+    }
+
+    // Static callback for packet arrival, runs on the libpcap thread of a source and only queues the frame
     static void onPacketArrives(pcpp::RawPacket *packet, pcpp::PcapLiveDevice *dev, void *cookie) {
-        CaptureManager *manager = (CaptureManager *)cookie;
-        manager->handlePacket(packet);
+        CaptureSource *source = (CaptureSource *)cookie;
+        source->manager->selectWorker(packet->getRawData(), packet->getRawDataLen())
+            .enqueue(source->index, packet->getRawData(), packet->getRawDataLen(), packet->getPacketTimeStamp());
+    }
+
+private:
+    /**
+     * @brief Starts the TPACKET_V3 backend.
+     *
+     * Each socket capture thread runs the analyzers of the worker owning each frame directly on
+     * the mapped ring, and a block is released to the kernel once all of its frames are analyzed.
+     * The workers are built without rings, which would never hold a frame, but their threads are
+     * still started: their idle loop ages the hosts out and publishes the snapshots of the shards
+     * that no frame reaches anymore. With several sockets per interface, the sockets of an
+     * interface join a fanout group of their own.
+     */
+    void startTPacketCapture() {
+        // At least one analyzer set per socket, so that the sockets seldom wait on each other
+        workerCount = std::max(workerCount, tpacketSockets * sources.size());
+
+        createWorkers(0);
+        if (!customFilter) {
+            captureFilter = buildCaptureFilter(workers.front()->getInterests());
+        }
+        for (auto& worker : workers) {
+            worker->start();
+        }
+        std::cout << "Capture filter: " << (captureFilter.empty() ? "none" : captureFilter) << std::endl;
+
+        for (auto& source : sources) {
+            TPacketCapture::Config config = tpacketConfig;
+            if (tpacketSockets > 1 && config.fanoutGroup == 0) {
+                // Fanout group ids are per network namespace, derive them from the process id
+                config.fanoutGroup = static_cast<uint16_t>((getpid() + source->index * 2) & 0xffff) | 1;
+            } else if (config.fanoutGroup != 0) {
+                config.fanoutGroup = static_cast<uint16_t>(config.fanoutGroup + source->index);
+            }
+
+            for (size_t i = 0; i < tpacketSockets; i++) {
+                auto tpacket = std::make_unique<TPacketCapture>(source->name, config);
+                // Attached by open() before the socket is bound, so the ring only ever holds filtered frames
+                if (!captureFilter.empty() && !tpacket->setFilter(captureFilter)) {
+                    std::cerr << "Error: Unable to set the capture filter, capturing everything" << std::endl;
+                }
+                if (!tpacket->open()) {
+                    std::cerr << "Error: Unable to open the TPACKET_V3 ring on " << source->name << std::endl;
+                    exit(1);
+                }
+                source->tpackets.push_back(std::move(tpacket));
+            }
+
+            std::cout << "Starting TPACKET_V3 capture on interface: " << source->name
+                      << " (" << tpacketSockets << " socket(s)"
+                      << (config.fanoutGroup ? ", fanout group " + std::to_string(config.fanoutGroup) : std::string())
+                      << ", " << config.blockCount << " blocks of " << config.blockSize << " bytes, "
+                      << config.blockTimeoutMs << " ms block timeout)" << std::endl;
+        }
+
+        for (auto& source : sources) {
+            size_t index = source->index;
+            for (auto& tpacket : source->tpackets) {
+                tpacket->startCapture([this, index](const uint8_t* data, size_t length, const timespec& timestamp) {
+                    pcpp::RawPacket rawPacket(data, static_cast<int>(length), timestamp, false);
+                    selectWorker(data, length).handlePacket(index, &rawPacket);
+                });
+            }
+        }
+    }
+
+    // Build the workers and their host shards once the analyzers are registered, with one ring per interface
+    // of a capacity, none if 0
+    void createWorkers(size_t capacity) {
+        std::vector<std::string> names;
+        for (const auto& source : sources) {
+            names.push_back(source->name);
+        }
+        createWorkers(names, capacity);
     }
 
-    // Handle and distribute packet to all analyzers
-    void handlePacket(pcpp::RawPacket *rawPacket) {
-        // Parse the raw packet
-        pcpp::Packet parsedPacket(rawPacket);
+    // Build the workers and their host shards, with one ring per named source
+    void createWorkers(const std::vector<std::string>& names, size_t capacity) {
+        if (workers.empty()) {
+            for (size_t i = 0; i < workerCount; i++) {
+                workers.push_back(std::make_unique<AnalysisWorker>(i, capacity, analyzerFactories, names));
+                // Hosts are spread evenly over the shards by their MAC address
+                size_t shardHosts = expectedHosts / workerCount + 1;
+                workers.back()->withHosts([this, shardHosts](HostManager& hostManager) {
+                    hostManager.reserve(shardHosts);
+                    hostManager.setSequenceCounter(hostSequence);
+                    hostManager.setAgingPolicy(agingPolicy);
+                });
+            }
+            if (!warmStartFile.empty()) {
+                loadSnapshot(warmStartFile);
+            }
+            if (observationLog) {
+                replayObservationLog();
+            }
+        }
+        startTime = std::chrono::steady_clock::now();
+    }
+
+    // Attach the capture filter to a device, built from the analyzers' interests by default
+    void applyCaptureFilter(pcpp::IPcapDevice& pcapDevice) {
+        if (!customFilter) {
+            captureFilter = buildCaptureFilter(workers.front()->getInterests());
+        }
+        if (captureFilter.empty()) {
+            std::cout << "Capture filter: none" << std::endl;
+            return;
+        }
+        if (!pcapDevice.setFilter(captureFilter)) {
+            std::cerr << "Error: Unable to set the capture filter, capturing everything: " << captureFilter << std::endl;
+            return;
+        }
+        std::cout << "Capture filter: " << captureFilter << std::endl;
+    }
+
+    /**
+     * @brief Extracts the MAC address of the host a frame is about, packed in 48 bits.
+     *
+     * This is the Ethernet source address, except for ARP (sender hardware address) and DHCP
+     * (client hardware address) where the frame may be relayed or proxied by another device:
+     * the analyzers key the host on those fields, so the shard must be picked from them too.
+     */
+    static uint64_t hostKey(const uint8_t* data, size_t length) {
+        auto mac = [data](size_t offset) {
+            uint64_t key = 0;
+            for (size_t i = 0; i < 6; i++) {
+                key = (key << 8) | data[offset + i];
+            }
+            return key;
+        };
+
+        if (length < 14) {
+            return 0;
+        }
+        size_t offset = 12;
+        uint16_t etherType = (data[offset] << 8) | data[offset + 1];
+        // Skip 802.1Q / 802.1ad tags
+        while ((etherType == 0x8100 || etherType == 0x88a8) && length >= offset + 6) {
+            offset += 4;
+            etherType = (data[offset] << 8) | data[offset + 1];
+        }
+        offset += 2;
+
+        if (etherType == 0x0806 && length >= offset + 14) {
+            return mac(offset + 8);
+        }
+        if (etherType == 0x0800 && length >= offset + 20 && data[offset + 9] == 17) {
+            size_t udp = offset + (data[offset] & 0x0f) * 4;
+            if (length >= udp + 8 + 34) {
+                uint16_t srcPort = (data[udp] << 8) | data[udp + 1];
+                uint16_t dstPort = (data[udp + 2] << 8) | data[udp + 3];
+                if ((srcPort == 67 || srcPort == 68) && (dstPort == 67 || dstPort == 68)) {
+                    return mac(udp + 8 + 28);
+                }
+            }
+        }
+        return mac(6);
+    }
+
+    // Index of the worker owning the shard of a host key
+    size_t shardOf(uint64_t key) const {
+        if (workers.size() == 1) {
+            return 0;
+        }
+        uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+        return (hash >> 32) % workers.size();
+    }
+
+    // Pick the worker owning the host shard of a frame
+    AnalysisWorker& selectWorker(const uint8_t* data, size_t length) {
+        return *workers[shardOf(hostKey(data, length))];
+    }
+
+    // Apply the logged observations on top of the snapshot, then log the new ones
+    void replayObservationLog() {
+        ObservationLog::ReplayResult result = ObservationLog::replay(observationLog->getPath(),
+            [this](Observation observation) {
+                workers[shardOf(HostTable::key(HostManager::observedMac(observation)))]->withHosts([&observation](HostManager& hostManager) {
+                    hostManager.replayObservation(std::move(observation));
+                });
+            });
+        if (result.bytes > 0) {
+            std::cout << "Observations replayed from " << observationLog->getPath() << ": " << result.observations
+                      << " observations, " << result.bytes << " bytes in " << result.elapsed.count() / 1000.0 << " ms" << std::endl;
+        }
+        if (!observationLog->open()) {
+            std::cerr << "Error: Observations not logged to " << observationLog->getPath() << std::endl;
+            return;
+        }
+        for (auto& worker : workers) {
+            worker->withHosts([this](HostManager& hostManager) {
+                hostManager.setObservationLog(observationLog.get());
+            });
+        }
+    }
 
-        // Distribute packet to all analyzers
-        for (Analyzer* analyzer : analyzers) {
-            analyzer->analyzePacket(parsedPacket);
+    // Hand the hosts of a snapshot file to their shards and continue the update sequence after it
+    void loadSnapshot(const std::string& path) {
+        SnapshotFile::LoadResult result = SnapshotFile::load(path, [this](Host&& host) {
+            workers[shardOf(HostTable::key(host.getMACAddress()))]->withHosts([&host](HostManager& hostManager) {
+                hostManager.restoreHost(std::move(host));
+            });
+        });
+        if (!result.loaded) {
+            std::cerr << "Warning: Hosts not restored from " << path << ": " << result.error << std::endl;
+            return;
         }
+        hostSequence->store(std::max(hostSequence->load(), result.sequence));
+        std::cout << "Hosts restored from " << path << ": " << result.hosts << " hosts, " << result.observations
+                  << " observations, " << result.bytes << " bytes in " << result.elapsed.count() / 1000.0 << " ms"
+                  << ", sequence " << result.sequence << std::endl;
     }
-};
\ No newline at end of file
+};
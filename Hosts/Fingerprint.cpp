@@ -0,0 +1,119 @@
+#include "Fingerprint.hpp"
+#include "ObservationCodec.hpp"
+
+void FingerprintHasher::add(const void* data, size_t length) {
+    state = (state ^ checksum64(static_cast<const uint8_t*>(data), length)) * 0x100000001b3ull;
+    state ^= state >> 29;
+}
+
+void FingerprintHasher::addMac(const pcpp::MacAddress& mac) {
+    uint8_t bytes[6];
+    mac.copyTo(bytes);
+    add(bytes, sizeof(bytes));
+}
+
+void FingerprintHasher::addIp(const pcpp::IPAddress& ip) {
+    uint8_t bytes[17] = {};
+    if (ip.isIPv4()) {
+        bytes[0] = 4;
+        uint32_t address = ip.getIPv4().toInt();
+        std::memcpy(bytes + 1, &address, 4);
+        add(bytes, 5);
+    } else {
+        bytes[0] = 6;
+        std::memcpy(bytes + 1, ip.getIPv6().toBytes(), 16);
+        add(bytes, 17);
+    }
+}
+
+void FingerprintHasher::closeUnordered() {
+    addValue(unorderedSum);
+    addValue(unorderedCount);
+    unorderedSum = 0;
+    unorderedCount = 0;
+}
+
+uint64_t fingerprintOf(const Observation& observation) {
+    FingerprintHasher hasher;
+    hasher.addValue(static_cast<uint8_t>(protocolOf(observation)));
+    visitObservation(Overloaded{
+        [&hasher](const DHCPData& dhcp) {
+            hasher.addMac(dhcp.clientMac);
+            hasher.addIp(dhcp.ipAddress);
+            hasher.addString(dhcp.hostname);
+            hasher.addIp(dhcp.dhcpServerIp);
+            hasher.addIp(dhcp.gatewayIp);
+            hasher.addIp(dhcp.dnsServerIp);
+        },
+        [&hasher](const mDNSData& mdns) {
+            hasher.addString(mdns.queriedDomain);
+            hasher.addMac(mdns.clientMac);
+            hasher.addString(mdns.hostname);
+            hasher.addIp(mdns.ipAddress);
+        },
+        [&hasher](const ARPData& arp) {
+            hasher.addMac(arp.senderMac);
+            hasher.addIp(arp.senderIp);
+            hasher.addIp(arp.targetIp);
+        },
+        [&hasher](const SSDPData& ssdp) {
+            hasher.addMac(ssdp.senderMAC);
+            hasher.addValue(ssdp.senderIP.toInt());
+            for (const auto& header : ssdp.ssdpHeaders) {
+                FingerprintHasher pair;
+                pair.addString(header.first);
+                pair.addString(header.second);
+                hasher.addUnordered(pair.value());
+            }
+            hasher.closeUnordered();
+        },
+        [&hasher](const LLDPData& lldp) {
+            hasher.addMac(lldp.senderMAC);
+            hasher.addString(lldp.portID);
+            hasher.addString(lldp.portDescription);
+            hasher.addString(lldp.systemName);
+            hasher.addString(lldp.systemDescription);
+        },
+        [&hasher](const CDPData& cdp) {
+            auto addAddresses = [&hasher](const CDPLayer::Addresses& list) {
+                hasher.addValue(static_cast<uint64_t>(list.addresses.size()));
+                for (const CDPLayer::Address& address : list.addresses) {
+                    hasher.addValue(address.protocolType);
+                    hasher.addValue(address.protocolLength);
+                    hasher.addValue(address.protocol);
+                    hasher.add(address.address, address.addressLength);
+                }
+            };
+            hasher.addMac(cdp.senderMAC);
+            hasher.addValue(static_cast<uint8_t>(cdp.deviceId.subtype));
+            hasher.addString(cdp.deviceId.id);
+            addAddresses(cdp.addresses);
+            hasher.addString(cdp.portId);
+            hasher.addValue(cdp.capabilities);
+            hasher.addString(cdp.capabilitiesStr);
+            hasher.addString(cdp.softwareVersion);
+            hasher.addString(cdp.platform);
+            hasher.addString(cdp.vtpManagementDomain);
+            hasher.addValue(cdp.nativeVlan);
+            hasher.addValue(cdp.duplex);
+            hasher.addValue(cdp.trustBitmap);
+            hasher.addValue(cdp.untrustedPortCos);
+            addAddresses(cdp.mgmtAddresses);
+        },
+        [&hasher](const STPData& stp) {
+            // Copies of the packed fields
+            hasher.addMac(stp.senderMAC);
+            hasher.addValue(uint16_t(stp.rootIdentifier.priority));
+            hasher.addValue(uint8_t(stp.rootIdentifier.systemIDExtension));
+            hasher.addValue(uint64_t(stp.rootIdentifier.systemID));
+            hasher.addValue(uint16_t(stp.bridgeIdentifier.priority));
+            hasher.addValue(uint8_t(stp.bridgeIdentifier.systemIDExtension));
+            hasher.addValue(uint64_t(stp.bridgeIdentifier.systemID));
+        },
+        [&hasher](const WOLData& wol) {
+            hasher.addMac(wol.senderMAC);
+            hasher.addMac(wol.targetMAC);
+        },
+    }, observation);
+    return hasher.value();
+}
@@ -0,0 +1,52 @@
+#ifndef FINGERPRINT_HPP
+#define FINGERPRINT_HPP
+
+#include "ProtocolData.hpp"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @class FingerprintHasher
+ *
+ * @brief Streaming 64-bit hash of the fields of an observation.
+ *
+ * Every field is hashed with its length, so that field boundaries are part of the hash and
+ * ("ab", "c") and ("a", "bc") differ. The hash is stable within a process only.
+ */
+class FingerprintHasher {
+  public:
+    void add(const void* data, size_t length);
+    template <typename T>
+    void addValue(const T& value) {
+        add(&value, sizeof(value));
+    }
+    void addString(const std::string& value) { add(value.data(), value.size()); }
+    // Equal interned strings share their ID, which is hashed instead of the text
+    void addString(const InternedString& value) { addValue(value.getId()); }
+    void addMac(const pcpp::MacAddress& mac);
+    // Version then address bytes, so that equal IPv4 and IPv6 bytes differ
+    void addIp(const pcpp::IPAddress& ip);
+    // Order-insensitive: the hashes of the elements are summed, then added with their count
+    void addUnordered(uint64_t elementHash) { unorderedSum += elementHash; unorderedCount++; }
+    void closeUnordered();
+
+    // Never 0, which marks a fingerprint not computed yet
+    uint64_t value() const { return state != 0 ? state : 1; }
+
+  private:
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    uint64_t unorderedSum = 0;
+    uint64_t unorderedCount = 0;
+};
+
+/**
+ * @brief Canonical content hash of an observation.
+ *
+ * Covers the fields ProtocolDataComparator compares and nothing else: not the timestamps, the
+ * ingress, the lifetime nor the history counters. Equal observations have equal fingerprints;
+ * SSDP headers are hashed regardless of their order, as they are compared.
+ */
+uint64_t fingerprintOf(const Observation& observation);
+
+#endif // FINGERPRINT_HPP
@@ -2,45 +2,90 @@
 
 std::map<std::string, std::string> vendorDatabase;
 
-void Host::getProtocolData(ProtocolType protocol, ProtocolData& data) const {
-    auto& protocolSet = protocols_data[static_cast<size_t>(protocol)];
-    auto it = protocolSet.find(std::make_unique<ProtocolData>(protocol));
+ObservationHistory& Host::historyOf(ProtocolType protocol) {
+    auto position = histories.begin() + historyIndex(protocol);
+    if (!hasHistory(protocol)) {
+        position = histories.emplace(position, histories.get_allocator().resource());
+        protocols |= 1u << static_cast<unsigned>(protocol);
+    }
+    return *position;
+}
 
-    if (it != protocolSet.end()) {
-        data = **it;
+void Host::moveHistories(std::pmr::vector<ObservationHistory>& from) {
+    if (histories.get_allocator() == from.get_allocator()) {
+        histories = std::move(from);
+        return;
+    }
+    // The moved histories would keep allocating from the other resource, rebuild them in this one
+    histories.clear();
+    histories.reserve(from.size());
+    for (auto& history : from) {
+        histories.emplace_back(histories.get_allocator().resource()) = std::move(history);
     }
+    from.clear();
 }
 
-void Host::updateProtocolData(ProtocolType protocol, std::unique_ptr<ProtocolData> data) {
-    auto& protocolSet = protocols_data[static_cast<size_t>(protocol)];
-    auto it = protocolSet.find(data);
+void Host::getProtocolData(ProtocolType protocol, ProtocolData& data) const {
+    if (!hasHistory(protocol)) {
+        return;
+    }
+    if (const Observation* latest = histories[historyIndex(protocol)].latest()) {
+        data = dataOf(*latest);
+    }
+}
+
+void Host::updateProtocolData(Observation observation) {
+    // Refreshes the equal observation if one is kept, otherwise adds it
+    historyOf(protocolOf(observation)).record(std::move(observation));
+}
 
-    // Check if the entry already exists
-    if (it != protocolSet.end()) {
-        // Update the timestamp if the entry already exists
-        (*it)->timestamp = data->timestamp;
-        // Insert the new entry
-        //protocolSet.insert(std::move(data));
+void Host::editProtocolData(Observation prev_data, Observation new_data) {
+    auto& history = historyOf(protocolOf(new_data));
+    history.remove(prev_data);
+    history.record(std::move(new_data));
+}
 
-    } else {
-        // Insert the new entry
-        protocolSet.insert(std::move(data));
+size_t Host::expireProtocolData(int64_t now, int64_t& nextExpiry) {
+    size_t removed = 0;
+    nextExpiry = 0;
+    for (auto& history : histories) {
+        removed += history.removeIf([&](const ProtocolData& data) {
+            if (data.expiresAt != 0 && data.expiresAt <= now) {
+                return true;
+            }
+            if (data.expiresAt != 0 && (nextExpiry == 0 || data.expiresAt < nextExpiry)) {
+                nextExpiry = data.expiresAt;
+            }
+            return false;
+        });
     }
+    if (removed == 0) {
+        return 0;
+    }
+    // Drop the histories left empty, so that a host only holds those of the protocols it still has
+    uint8_t kept = 0;
+    size_t index = 0;
+    for (unsigned protocol = 0; protocol < 8; ++protocol) {
+        if (protocols & (1u << protocol)) {
+            if (!histories[index].empty()) {
+                kept |= 1u << protocol;
+            }
+            ++index;
+        }
+    }
+    histories.erase(std::remove_if(histories.begin(), histories.end(), [](const ObservationHistory& history) { return history.empty(); }),
+                    histories.end());
+    protocols = kept;
+    return removed;
 }
 
-void Host::editProtocolData(ProtocolType protocol, std::unique_ptr<ProtocolData> prev_data, std::unique_ptr<ProtocolData> new_data) {
-    auto& protocolSet = protocols_data[static_cast<size_t>(protocol)];
-    auto it = protocolSet.find(prev_data);
-
-    if (it != protocolSet.end()) {
-        // Update the timestamp if the entry already exists
-        (*it)->timestamp = new_data->timestamp;
-        protocolSet.insert(std::move(new_data));
-        protocolSet.erase(it);
-    } else {
-        // Insert the new entry
-        protocolSet.insert(std::move(new_data));
+bool Host::hasProtocolData() const {
+    for (const auto& history : histories) {
+        if (!history.empty()) {
+            return true;
+        }
     }
+    return false;
 }
 
 // Function to load vendor information from a file into the map
@@ -115,9 +160,13 @@ std::string getVendorName(const std::string& mac, const std::map<std::string, st
 
 std::string pcppMACAddressToString(const pcpp::MacAddress& mac, const std::map<std::string, std::string>& vendorDatabase) {
     std::string macStr = mac.toString();
+    #ifdef DEBUG
     std::cout << "MAC: " << macStr << std::endl;
+    #endif
     std::transform(macStr.begin(), macStr.end(), macStr.begin(), ::toupper);
     std::string vendorName = getVendorName(macStr.substr(0, 8), vendorDatabase);
+    #ifdef DEBUG
     std::cout << "sub: " << macStr.substr(0, 8) << std::endl;
+    #endif
     return macStr + " (" + vendorName + ")";
 }
\ No newline at end of file
@@ -4,14 +4,18 @@
 #include "MacAddress.h"
 #include "IPv4Layer.h"
 #include "ProtocolData.hpp"
+#include "ObservationHistory.hpp"
 
 #include <string>
 #include <unordered_map>
 #include <ctime>
 #include <iostream>
 #include <fstream>
-#include <array>
-#include <set>
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
 #include <json/json.h>
 #include <boost/algorithm/string.hpp>
 
@@ -31,51 +35,148 @@ extern std::map<std::string, std::string> vendorDatabase;
  * It provides methods to update and retrieve host information, as well as to convert host data to JSON format.
  * 
  * The Host class also provides methods to update and retrieve protocol-specific data for a host.
+ *
+ * The record is kept compact for stores of millions of hosts: the IPv4 address and the first and
+ * last seen seconds are stored as 32-bit integers, the hostname and the interfaces are interned,
+ * and a history is only allocated for the protocols the host was actually observed with, in
+ * protocol order, indexed by a bitmask of those protocols. A host seen by ARP alone holds a
+ * single history.
+ *
+ * Its interfaces and observation histories are allocated from a memory resource, the pool of
+ * the host store it belongs to; a host moved to a store with another resource is copied into it.
  */
 class Host {
   public:
-    Host() : mac_address(pcpp::MacAddress::Zero), ip_address(pcpp::IPv4Address::Zero), host_name("") {}
-    Host(const pcpp::MacAddress& mac, const pcpp::IPAddress& ip = pcpp::IPv4Address::Zero, const std::string& hostname = "", const timespec& first = timespec(), const timespec& last = timespec())
-      : ip_address(ip), mac_address(mac), host_name(hostname), first_seen(first), last_seen(last) {}
+    Host() : mac_address(pcpp::MacAddress::Zero) {}
+    // Empty host allocating from a memory resource
+    explicit Host(std::pmr::memory_resource* resource)
+      : mac_address(pcpp::MacAddress::Zero), interfaces(resource), histories(resource) {}
+    Host(const pcpp::MacAddress& mac, const pcpp::IPAddress& ip = pcpp::IPv4Address::Zero, const std::string& hostname = "", const timespec& first = timespec(), const timespec& last = timespec(),
+         std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : mac_address(mac), host_name(hostname), first_seen(static_cast<uint32_t>(first.tv_sec)), last_seen(static_cast<uint32_t>(last.tv_sec)),
+        interfaces(resource), histories(resource) {
+        setIPAddress(ip);
+    }
 
     // Move constructor
     Host(Host&& other) noexcept
-        : ip_address(std::move(other.ip_address)),
-          mac_address(std::move(other.mac_address)),
-          host_name(std::move(other.host_name)),
+        : mac_address(std::move(other.mac_address)),
+          protocols(other.protocols),
+          dirty(other.dirty),
+          ipv4(other.ipv4),
           first_seen(other.first_seen),
           last_seen(other.last_seen),
-          protocols_data(std::move(other.protocols_data)) {}
+          host_name(std::move(other.host_name)),
+          json_index(other.json_index),
+          sequence(other.sequence),
+          expiry(other.expiry),
+          interfaces(std::move(other.interfaces)),
+          histories(std::move(other.histories)) {
+        other.protocols = 0;
+    }
 
     // Move assignment operator
     Host& operator=(Host&& other) noexcept {
         if (this != &other) {
-            ip_address = std::move(other.ip_address);
             mac_address = std::move(other.mac_address);
-            host_name = std::move(other.host_name);
+            protocols = other.protocols;
+            dirty = other.dirty;
+            ipv4 = other.ipv4;
             first_seen = other.first_seen;
             last_seen = other.last_seen;
-            protocols_data = std::move(other.protocols_data);
+            host_name = std::move(other.host_name);
+            json_index = other.json_index;
+            sequence = other.sequence;
+            expiry = other.expiry;
+            interfaces = std::move(other.interfaces);
+            moveHistories(other.histories);
+            other.protocols = 0;
         }
         return *this;
     }
 
     // Getters
-    pcpp::IPAddress getIPAddress() const { return ip_address; }
+    pcpp::IPAddress getIPAddress() const { return pcpp::IPv4Address(ipv4); }
     pcpp::MacAddress getMACAddress() const { return mac_address; }
-    std::string getHostName() const { return host_name; }
-    timespec getFirstSeen() const { return first_seen; }
-    timespec getLastSeen() const { return last_seen; }
+    std::string getHostName() const { return host_name.str(); }
+    // Whole seconds, the sub-second part is not kept
+    timespec getFirstSeen() const { return timespec{static_cast<time_t>(first_seen), 0}; }
+    timespec getLastSeen() const { return timespec{static_cast<time_t>(last_seen), 0}; }
+    // In name order
+    const std::pmr::vector<InternedString>& getInterfaces() const { return interfaces; }
+    uint64_t getSequence() const { return sequence; }
+    // Bit i set when the host has observations of ProtocolType i
+    uint8_t getProtocols() const { return protocols; }
 
     // Setters                  
-    void setIPAddress(const pcpp::IPAddress& ip) { ip_address = ip; }
+    // Hosts are addressed by IPv4, the only addresses the analyzers set; others are ignored
+    void setIPAddress(const pcpp::IPAddress& ip) {
+        if (ip.isIPv4()) {
+            ipv4 = ip.getIPv4().toInt();
+        }
+    }
     void setMACAddress(const pcpp::MacAddress& mac) { mac_address = mac; }
     void setHostName(const std::string& hostname) { host_name = hostname; }
-    void setFirstSeen(const timespec& first) { first_seen = first; }
-    void setLastSeen(const timespec& last) { last_seen = last; }
+    void setFirstSeen(const timespec& first) { first_seen = static_cast<uint32_t>(first.tv_sec); }
+    void setLastSeen(const timespec& last) { last_seen = static_cast<uint32_t>(last.tv_sec); }
+    // Interned on its first addition only, a known interface costs a lookup
+    void addInterface(const std::string& interface) {
+        auto it = std::lower_bound(interfaces.begin(), interfaces.end(), interface,
+                                   [](const InternedString& kept, const std::string& name) { return kept.view() < name; });
+        if (it == interfaces.end() || it->view() != interface) {
+            interfaces.insert(it, InternedString(interface));
+        }
+    }
+    void addInterface(const char* interface) { addInterface(std::string(interface)); }
+    // An interface already interned, a known one costs a lookup and no string compare once found
+    void addInterface(const InternedString& interface) {
+        auto it = std::lower_bound(interfaces.begin(), interfaces.end(), interface.view(),
+                                   [](const InternedString& kept, std::string_view name) { return kept.view() < name; });
+        if (it == interfaces.end() || *it != interface) {
+            interfaces.insert(it, interface);
+        }
+    }
+    void setSequence(uint64_t seq) { sequence = seq; }
+    // Copy the latest observation of a protocol, left untouched if none
     void getProtocolData(ProtocolType protocol, ProtocolData& data) const;
-    void updateProtocolData(ProtocolType protocol, std::unique_ptr<ProtocolData> data);
-    void editProtocolData(ProtocolType protocol, std::unique_ptr<ProtocolData> prev_data, std::unique_ptr<ProtocolData> new_data);
+    // Latest observation of a protocol, nullptr if none; only its lifetime fields may change
+    Observation* latestObservation(ProtocolType protocol) {
+        return hasHistory(protocol) ? histories[historyIndex(protocol)].latest() : nullptr;
+    }
+    void updateProtocolData(Observation observation);
+    void editProtocolData(Observation prev_data, Observation new_data);
+    // Remove the observations expired at a realtime second, returns how many; nextExpiry is set to the earliest remaining one, 0 if none
+    size_t expireProtocolData(int64_t now, int64_t& nextExpiry);
+    bool hasProtocolData() const;
+    // Call a function with every observation of the host, in protocol order
+    template <typename Function>
+    void forEachProtocolData(Function&& function) const {
+        for (const auto& history : histories) {
+            for (const Observation& observation : history) {
+                function(observation);
+            }
+        }
+    }
+
+    // Call a function with every observation of the host, allowed to change its lifetime fields
+    template <typename Function>
+    void forEachProtocolData(Function&& function) {
+        for (auto& history : histories) {
+            history.forEach(function);
+        }
+    }
+
+    // Realtime second the aging timer of the host is due, 0 when none is scheduled
+    int64_t getExpiry() const { return expiry; }
+    void setExpiry(int64_t second) { expiry = second; }
+
+    // Changed since its JSON was last materialized
+    bool isDirty() const { return dirty; }
+    void setDirty(bool changed) { dirty = changed; }
+    // Position of the host in the materialized JSON array, NoJsonIndex until first materialized
+    static constexpr size_t NoJsonIndex = ~size_t(0);
+    size_t getJsonIndex() const { return json_index == NoIndex ? NoJsonIndex : json_index; }
+    void setJsonIndex(size_t index) { json_index = index == NoJsonIndex ? NoIndex : static_cast<uint32_t>(index); }
 
     // Date to string
     std::string dateToString(const timespec& ts) const {
@@ -90,125 +191,145 @@ class Host {
     Json::Value toJson() const {
         Json::Value hostJson;
         hostJson["MAC"] = pcppMACAddressToString(mac_address, vendorDatabase);
-        hostJson["IP"] = (ip_address == pcpp::IPv4Address::Zero) ? "" : ip_address.toString();
-        hostJson["HOSTNAME"] = host_name;
-        hostJson["FIRST SEEN"] = dateToString(first_seen);
-        hostJson["LAST SEEN"] = dateToString(last_seen);
+        hostJson["IP"] = ipv4 == 0 ? "" : pcpp::IPv4Address(ipv4).toString();
+        hostJson["HOSTNAME"] = host_name.str();
+        hostJson["FIRST SEEN"] = dateToString(getFirstSeen());
+        hostJson["LAST SEEN"] = dateToString(getLastSeen());
+        hostJson["SEQUENCE"] = Json::UInt64(sequence);
+        Json::Value interfacesJson(Json::arrayValue);
+        for (const InternedString& interface : interfaces) {
+            interfacesJson.append(interface.str());
+        }
+        hostJson["INTERFACES"] = interfacesJson;
 
         Json::Value protocolsJson;
-        for (const auto& protocolDataVector : protocols_data) {
-            for (const auto& protocolDataPtr : protocolDataVector) {
-                if (!protocolDataPtr) {
-                    continue; // Skip uninitialized or empty protocol data slots
-                }
-                ProtocolData* protocol_data = protocolDataPtr.get();
-                if (protocol_data->protocol == ProtocolType::DHCP) {
-                    DHCPData* dhcp_data = static_cast<DHCPData*>(protocol_data);
-                    Json::Value dhcpJson;
-                    dhcpJson["TIMESTAMP"] = dateToString(dhcp_data->timestamp);
-                    dhcpJson["CLIENT MAC"] = dhcp_data->clientMac.toString();
-                    dhcpJson["IP"] = dhcp_data->ipAddress.toString();
-                    dhcpJson["HOSTNAME"] = dhcp_data->hostname;
-                    dhcpJson["DHCP SERVER IP"] = dhcp_data->dhcpServerIp.toString();
-                    dhcpJson["GATEWAY IP"] = dhcp_data->gatewayIp.toString();
-                    dhcpJson["DNS SERVER IP"] = dhcp_data->dnsServerIp.toString();
-                    protocolsJson["DHCP"].append(dhcpJson);
-                }
-                else if (protocol_data->protocol == ProtocolType::ARP) {
-                    ARPData* arp_data = static_cast<ARPData*>(protocol_data);
-                    Json::Value arpJson;
-                    arpJson["TIMESTAMP"] = dateToString(arp_data->timestamp);
-                    arpJson["SENDER MAC"] = arp_data->senderMac.toString();
-                    arpJson["SENDER IP"] = arp_data->senderIp.toString();
-                    arpJson["TARGET IP"] = arp_data->targetIp.toString();
-                    protocolsJson["ARP"].append(arpJson);
-                }
-                else if (protocol_data->protocol == ProtocolType::LLDP) {
-                    LLDPData* lldp_data = static_cast<LLDPData*>(protocol_data);
-                    Json::Value lldpJson;
-                    lldpJson["TIMESTAMP"] = dateToString(lldp_data->timestamp);
-                    lldpJson["SENDER MAC"] = lldp_data->senderMAC.toString();
-                    lldpJson["PORT ID"] = lldp_data->portID;
-                    lldpJson["PORT DESCRIPTION"] = lldp_data->portDescription;
-                    lldpJson["SYSTEM NAME"] = lldp_data->systemName;
-                    lldpJson["SYSTEM DESCRIPTION"] = lldp_data->systemDescription;
-                    protocolsJson["LLDP"].append(lldpJson);
-                }
-                else if (protocol_data->protocol == ProtocolType::STP) {
-                    STPData* stp_data = static_cast<STPData*>(protocol_data);
-                    Json::Value stpJson;
-                    stpJson["TIMESTAMP"] = dateToString(stp_data->timestamp);
-                    stpJson["SENDER MAC"] = stp_data->senderMAC.toString();
-                    uint16_t reversedRootIdentifier = reverseBytes16(stp_data->rootIdentifier.priority);
-                    stpJson["ROOT IDENTIFIER"]["PRIORITY"] = reversedRootIdentifier;
-                    stpJson["ROOT IDENTIFIER"]["SYSTEM ID EXTENSION"] = stp_data->rootIdentifier.systemIDExtension;
-                    uint64_t reversedRootSystemID = reverseBytes48(stp_data->rootIdentifier.systemID);
-                    stpJson["ROOT IDENTIFIER"]["SYSTEM ID"] = pcpp::MacAddress(reinterpret_cast<uint8_t*>(&reversedRootSystemID)).toString();
-                    uint16_t reversedBridgeIdentifier = reverseBytes16(stp_data->bridgeIdentifier.priority);
-                    stpJson["BRIDGE IDENTIFIER"]["PRIORITY"] = reversedBridgeIdentifier;
-                    stpJson["BRIDGE IDENTIFIER"]["SYSTEM ID EXTENSION"] = stp_data->bridgeIdentifier.systemIDExtension;
-                    uint64_t reversedBridgeSystemID = reverseBytes48(stp_data->bridgeIdentifier.systemID);
-                    stpJson["BRIDGE IDENTIFIER"]["SYSTEM ID"] = pcpp::MacAddress(reinterpret_cast<uint8_t*>(&reversedBridgeSystemID)).toString();
-                    protocolsJson["STP"].append(stpJson);
-                }
-                else if (protocol_data->protocol == ProtocolType::SSDP) {
-                    SSDPData* ssdp_data = static_cast<SSDPData*>(protocol_data);
-                    Json::Value ssdpJson;
-                    ssdpJson["TIMESTAMP"] = dateToString(ssdp_data->timestamp);
-                    ssdpJson["TYPE"] = ssdp_data->ssdpType == SSDPLayer::SSDPType::NOTIFY ? "NOTIFY" : "M-SEARCH";
-                    Json::Value headersJson;
-                    for (const auto& header : ssdp_data->ssdpHeaders) {
-                        headersJson[header.first] = header.second;
-                    }
-                    ssdpJson["HEADERS"] = headersJson;
-                    protocolsJson["SSDP"].append(ssdpJson);
-                }
-                else if (protocol_data->protocol == ProtocolType::CDP) {
-                    CDPData* cdp_data = static_cast<CDPData*>(protocol_data);
-                    Json::Value cdpJson;
-                    cdpJson["TIMESTAMP"] = dateToString(cdp_data->timestamp);
-                    cdpJson["DEVICE ID"] = cdp_data->deviceId.id;
-                    Json::Value addressesJson;
-                    for (const auto& address : cdp_data->addresses.addresses) {
-                        Json::Value addressJson;
-                        addressJson["PROTOCOL TYPE"] = address.protocolType;
-                        addressJson["PROTOCOL LENGTH"] = address.protocolLength;
-                        addressJson["PROTOCOL"] = address.protocol;
-                        addressJson["ADDRESS LENGTH"] = address.addressLength;
-                        addressJson["ADDRESS"] = getAddressString(address);
-                        addressesJson.append(addressJson);
-                    }
-                    cdpJson["ADDRESSES"] = addressesJson;
-                    cdpJson["PORT ID"] = cdp_data->portId;
-                    cdpJson["CAPABILITIES"] = cdp_data->capabilitiesStr;
-                    cdpJson["SOFTWARE VERSION"] = cdp_data->softwareVersion;
-                    cdpJson["PLATFORM"] = cdp_data->platform;
-                    cdpJson["VTP MANAGEMENT DOMAIN"] = cdp_data->vtpManagementDomain;
-                    cdpJson["NATIVE VLAN"] = cdp_data->nativeVlan;
-                    cdpJson["DUPLEX"] = cdp_data->duplex == 0 ? "Half" : "Full";
-                    cdpJson["TRUST BITMAP"] = cdp_data->trustBitmap;
-                    cdpJson["UNTRUSTED PORT COS"] = cdp_data->untrustedPortCos;
-                    Json::Value mgmtAddressesJson;
-                    for (const auto& mgmtAddress : cdp_data->mgmtAddresses.addresses) {
-                        Json::Value mgmtAddressJson;
-                        mgmtAddressJson["PROTOCOL TYPE"] = mgmtAddress.protocolType;
-                        mgmtAddressJson["PROTOCOL LENGTH"] = mgmtAddress.protocolLength;
-                        mgmtAddressJson["PROTOCOL"] = mgmtAddress.protocol;
-                        mgmtAddressJson["ADDRESS LENGTH"] = mgmtAddress.addressLength;
-                        mgmtAddressJson["ADDRESS"] = getAddressString(mgmtAddress);
-                        mgmtAddressesJson.append(mgmtAddressJson);
-                    }
-                    cdpJson["MGMT ADDRESSES"] = mgmtAddressesJson;
-                    protocolsJson["CDP"].append(cdpJson);
-                }
-                else if (protocol_data->protocol == ProtocolType::WOL) {
-                    WOLData* wol_data = static_cast<WOLData*>(protocol_data);
-                    Json::Value wolJson;
-                    wolJson["TIMESTAMP"] = dateToString(wol_data->timestamp);
-                    wolJson["SENDER MAC"] = wol_data->senderMAC.toString();
-                    wolJson["TARGET MAC"] = wol_data->targetMAC.toString();
-                    protocolsJson["WOL"].append(wolJson);
-                }
+        for (const auto& history : histories) {
+            for (const Observation& observation : history) {
+                visitObservation(Overloaded{
+                    [&](const DHCPData& dhcp_data) {
+                        Json::Value dhcpJson;
+                        dhcpJson["TIMESTAMP"] = dateToString(dhcp_data.timestamp);
+                        dhcpJson["INTERFACE"] = dhcp_data.ingress.str();
+                        dhcpJson["FIRST SEEN"] = dateToString(dhcp_data.firstSeen);
+                        dhcpJson["HITS"] = dhcp_data.hits;
+                        dhcpJson["CLIENT MAC"] = dhcp_data.clientMac.toString();
+                        dhcpJson["IP"] = dhcp_data.ipAddress.toString();
+                        dhcpJson["HOSTNAME"] = dhcp_data.hostname;
+                        dhcpJson["DHCP SERVER IP"] = dhcp_data.dhcpServerIp.toString();
+                        dhcpJson["GATEWAY IP"] = dhcp_data.gatewayIp.toString();
+                        dhcpJson["DNS SERVER IP"] = dhcp_data.dnsServerIp.toString();
+                        protocolsJson["DHCP"].append(dhcpJson);
+                    },
+                    [&](const ARPData& arp_data) {
+                        Json::Value arpJson;
+                        arpJson["TIMESTAMP"] = dateToString(arp_data.timestamp);
+                        arpJson["INTERFACE"] = arp_data.ingress.str();
+                        arpJson["FIRST SEEN"] = dateToString(arp_data.firstSeen);
+                        arpJson["HITS"] = arp_data.hits;
+                        arpJson["SENDER MAC"] = arp_data.senderMac.toString();
+                        arpJson["SENDER IP"] = arp_data.senderIp.toString();
+                        arpJson["TARGET IP"] = arp_data.targetIp.toString();
+                        protocolsJson["ARP"].append(arpJson);
+                    },
+                    [&](const LLDPData& lldp_data) {
+                        Json::Value lldpJson;
+                        lldpJson["TIMESTAMP"] = dateToString(lldp_data.timestamp);
+                        lldpJson["INTERFACE"] = lldp_data.ingress.str();
+                        lldpJson["FIRST SEEN"] = dateToString(lldp_data.firstSeen);
+                        lldpJson["HITS"] = lldp_data.hits;
+                        lldpJson["SENDER MAC"] = lldp_data.senderMAC.toString();
+                        lldpJson["PORT ID"] = lldp_data.portID;
+                        lldpJson["PORT DESCRIPTION"] = lldp_data.portDescription;
+                        lldpJson["SYSTEM NAME"] = lldp_data.systemName;
+                        lldpJson["SYSTEM DESCRIPTION"] = lldp_data.systemDescription.str();
+                        protocolsJson["LLDP"].append(lldpJson);
+                    },
+                    [&](const STPData& stp_data) {
+                        Json::Value stpJson;
+                        stpJson["TIMESTAMP"] = dateToString(stp_data.timestamp);
+                        stpJson["INTERFACE"] = stp_data.ingress.str();
+                        stpJson["FIRST SEEN"] = dateToString(stp_data.firstSeen);
+                        stpJson["HITS"] = stp_data.hits;
+                        stpJson["SENDER MAC"] = stp_data.senderMAC.toString();
+                        uint16_t reversedRootIdentifier = reverseBytes16(stp_data.rootIdentifier.priority);
+                        stpJson["ROOT IDENTIFIER"]["PRIORITY"] = reversedRootIdentifier;
+                        stpJson["ROOT IDENTIFIER"]["SYSTEM ID EXTENSION"] = stp_data.rootIdentifier.systemIDExtension;
+                        uint64_t reversedRootSystemID = reverseBytes48(stp_data.rootIdentifier.systemID);
+                        stpJson["ROOT IDENTIFIER"]["SYSTEM ID"] = pcpp::MacAddress(reinterpret_cast<uint8_t*>(&reversedRootSystemID)).toString();
+                        uint16_t reversedBridgeIdentifier = reverseBytes16(stp_data.bridgeIdentifier.priority);
+                        stpJson["BRIDGE IDENTIFIER"]["PRIORITY"] = reversedBridgeIdentifier;
+                        stpJson["BRIDGE IDENTIFIER"]["SYSTEM ID EXTENSION"] = stp_data.bridgeIdentifier.systemIDExtension;
+                        uint64_t reversedBridgeSystemID = reverseBytes48(stp_data.bridgeIdentifier.systemID);
+                        stpJson["BRIDGE IDENTIFIER"]["SYSTEM ID"] = pcpp::MacAddress(reinterpret_cast<uint8_t*>(&reversedBridgeSystemID)).toString();
+                        protocolsJson["STP"].append(stpJson);
+                    },
+                    [&](const SSDPData& ssdp_data) {
+                        Json::Value ssdpJson;
+                        ssdpJson["TIMESTAMP"] = dateToString(ssdp_data.timestamp);
+                        ssdpJson["INTERFACE"] = ssdp_data.ingress.str();
+                        ssdpJson["FIRST SEEN"] = dateToString(ssdp_data.firstSeen);
+                        ssdpJson["HITS"] = ssdp_data.hits;
+                        ssdpJson["TYPE"] = ssdp_data.ssdpType == SSDPLayer::SSDPType::NOTIFY ? "NOTIFY" : "M-SEARCH";
+                        Json::Value headersJson;
+                        for (const auto& header : ssdp_data.ssdpHeaders) {
+                            headersJson[header.first.str()] = header.second.str();
+                        }
+                        ssdpJson["HEADERS"] = headersJson;
+                        protocolsJson["SSDP"].append(ssdpJson);
+                    },
+                    [&](const CDPData& cdp_data) {
+                        Json::Value cdpJson;
+                        cdpJson["TIMESTAMP"] = dateToString(cdp_data.timestamp);
+                        cdpJson["INTERFACE"] = cdp_data.ingress.str();
+                        cdpJson["FIRST SEEN"] = dateToString(cdp_data.firstSeen);
+                        cdpJson["HITS"] = cdp_data.hits;
+                        cdpJson["DEVICE ID"] = cdp_data.deviceId.id;
+                        Json::Value addressesJson;
+                        for (const auto& address : cdp_data.addresses.addresses) {
+                            Json::Value addressJson;
+                            addressJson["PROTOCOL TYPE"] = address.protocolType;
+                            addressJson["PROTOCOL LENGTH"] = address.protocolLength;
+                            addressJson["PROTOCOL"] = address.protocol;
+                            addressJson["ADDRESS LENGTH"] = address.addressLength;
+                            addressJson["ADDRESS"] = getAddressString(address);
+                            addressesJson.append(addressJson);
+                        }
+                        cdpJson["ADDRESSES"] = addressesJson;
+                        cdpJson["PORT ID"] = cdp_data.portId;
+                        cdpJson["CAPABILITIES"] = cdp_data.capabilitiesStr.str();
+                        cdpJson["SOFTWARE VERSION"] = cdp_data.softwareVersion.str();
+                        cdpJson["PLATFORM"] = cdp_data.platform.str();
+                        cdpJson["VTP MANAGEMENT DOMAIN"] = cdp_data.vtpManagementDomain;
+                        cdpJson["NATIVE VLAN"] = cdp_data.nativeVlan;
+                        cdpJson["DUPLEX"] = cdp_data.duplex == 0 ? "Half" : "Full";
+                        cdpJson["TRUST BITMAP"] = cdp_data.trustBitmap;
+                        cdpJson["UNTRUSTED PORT COS"] = cdp_data.untrustedPortCos;
+                        Json::Value mgmtAddressesJson;
+                        for (const auto& mgmtAddress : cdp_data.mgmtAddresses.addresses) {
+                            Json::Value mgmtAddressJson;
+                            mgmtAddressJson["PROTOCOL TYPE"] = mgmtAddress.protocolType;
+                            mgmtAddressJson["PROTOCOL LENGTH"] = mgmtAddress.protocolLength;
+                            mgmtAddressJson["PROTOCOL"] = mgmtAddress.protocol;
+                            mgmtAddressJson["ADDRESS LENGTH"] = mgmtAddress.addressLength;
+                            mgmtAddressJson["ADDRESS"] = getAddressString(mgmtAddress);
+                            mgmtAddressesJson.append(mgmtAddressJson);
+                        }
+                        cdpJson["MGMT ADDRESSES"] = mgmtAddressesJson;
+                        protocolsJson["CDP"].append(cdpJson);
+                    },
+                    [&](const WOLData& wol_data) {
+                        Json::Value wolJson;
+                        wolJson["TIMESTAMP"] = dateToString(wol_data.timestamp);
+                        wolJson["INTERFACE"] = wol_data.ingress.str();
+                        wolJson["FIRST SEEN"] = dateToString(wol_data.firstSeen);
+                        wolJson["HITS"] = wol_data.hits;
+                        wolJson["SENDER MAC"] = wol_data.senderMAC.toString();
+                        wolJson["TARGET MAC"] = wol_data.targetMAC.toString();
+                        protocolsJson["WOL"].append(wolJson);
+                    },
+                    // Not kept, HostManager::updateHost() ignores mDNS
+                    [](const mDNSData&) {},
+                }, observation);
             }
         }
 
@@ -219,85 +340,106 @@ class Host {
 
     // Overload the << operator to print the host information
     friend std::ostream& operator<<(std::ostream& os, const Host& host) {
-        os << "IP Address: " << host.ip_address << std::endl;
+        os << "IP Address: " << host.getIPAddress() << std::endl;
         os << "MAC Address: " << pcppMACAddressToString(host.mac_address, vendorDatabase) << std::endl;
         os << "Host Name: " << host.host_name << std::endl;
-        os << "First Seen: " << host.dateToString(host.first_seen) << std::endl;
-        os << "Last Seen: " << host.dateToString(host.last_seen) << std::endl;
+        os << "First Seen: " << host.dateToString(host.getFirstSeen()) << std::endl;
+        os << "Last Seen: " << host.dateToString(host.getLastSeen()) << std::endl;
         
         // Print the protocols data
-        for (const auto& protocolDataVector : host.protocols_data) {
-            for (const auto& protocolDataPtr : protocolDataVector) {
-                if (!protocolDataPtr) {
-                    continue; // Skip uninitialized or empty protocol data slots
-                }   
-                ProtocolData* protocol_data = protocolDataPtr.get();
-                if (protocol_data->protocol == ProtocolType::DHCP) {
-                    DHCPData* dhcp_data = static_cast<DHCPData*>(protocol_data);
-                    os << "DHCP Data:" << std::endl;
-                    os << "\tTimestamp: " << host.dateToString(dhcp_data->timestamp) << std::endl;
-                    os << "\tClient MAC: " << dhcp_data->clientMac << std::endl;
-                    os << "\tIP Address: " << dhcp_data->ipAddress << std::endl;
-                    os << "\tHostname: " << dhcp_data->hostname << std::endl;
-                    os << "\tDHCP Server IP: " << dhcp_data->dhcpServerIp << std::endl;
-                    os << "\tGateway IP: " << dhcp_data->gatewayIp << std::endl;
-                    os << "\tDNS Server IP: " << dhcp_data->dnsServerIp << std::endl;
-                }
-                else if (protocol_data->protocol == ProtocolType::ARP) {
-                    ARPData* arp_data = static_cast<ARPData*>(protocol_data);
-                    os << "ARP Data:" << std::endl;
-                    os << "\tTimestamp: " << host.dateToString(arp_data->timestamp) << std::endl;
-                    os << "\tSender MAC: " << arp_data->senderMac << std::endl;
-                    os << "\tSender IP: " << arp_data->senderIp << std::endl;
-                    os << "\target IP: " << arp_data->targetIp << std::endl;
-                }
-                else if (protocol_data->protocol == ProtocolType::STP) {
-                    STPData* stp_data = static_cast<STPData*>(protocol_data);
-                    os << "STP Data:" << std::endl;
-                    os << "\tTimestamp: " << host.dateToString(stp_data->timestamp) << std::endl;
-                    os << "\tRoot Identifier:" << std::endl;
-                    uint16_t reversedRootIdentifier = reverseBytes16(stp_data->rootIdentifier.priority);
-                    os << "\t\tPriority: " << std::dec << reversedRootIdentifier << std::endl;
-                    os << "\t\tSystem ID Extension: " << std::dec << int(stp_data->rootIdentifier.systemIDExtension) << std::endl;
-                    uint64_t reversedSystemID = reverseBytes48(stp_data->rootIdentifier.systemID);
-                    // Only print the 6 bytes first of the system ID
-                    os << "\t\tSystem ID: " << std::hex << std::setfill('0');
-                    os << std::setw(2) << ((reversedSystemID >> 40) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedSystemID >> 32) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedSystemID >> 24) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedSystemID >> 16) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedSystemID >> 8) & 0xFF) << ":";
-                    os << std::setw(2) << (reversedSystemID & 0xFF) << std::endl;
+        for (const auto& history : host.histories) {
+            for (const Observation& observation : history) {
+                visitObservation(Overloaded{
+                    [&](const DHCPData& dhcp_data) {
+                        os << "DHCP Data:" << std::endl;
+                        os << "\tTimestamp: " << host.dateToString(dhcp_data.timestamp) << std::endl;
+                        os << "\tClient MAC: " << dhcp_data.clientMac << std::endl;
+                        os << "\tIP Address: " << dhcp_data.ipAddress << std::endl;
+                        os << "\tHostname: " << dhcp_data.hostname << std::endl;
+                        os << "\tDHCP Server IP: " << dhcp_data.dhcpServerIp << std::endl;
+                        os << "\tGateway IP: " << dhcp_data.gatewayIp << std::endl;
+                        os << "\tDNS Server IP: " << dhcp_data.dnsServerIp << std::endl;
+                    },
+                    [&](const ARPData& arp_data) {
+                        os << "ARP Data:" << std::endl;
+                        os << "\tTimestamp: " << host.dateToString(arp_data.timestamp) << std::endl;
+                        os << "\tSender MAC: " << arp_data.senderMac << std::endl;
+                        os << "\tSender IP: " << arp_data.senderIp << std::endl;
+                        os << "\target IP: " << arp_data.targetIp << std::endl;
+                    },
+                    [&](const STPData& stp_data) {
+                        os << "STP Data:" << std::endl;
+                        os << "\tTimestamp: " << host.dateToString(stp_data.timestamp) << std::endl;
+                        os << "\tRoot Identifier:" << std::endl;
+                        uint16_t reversedRootIdentifier = reverseBytes16(stp_data.rootIdentifier.priority);
+                        os << "\t\tPriority: " << std::dec << reversedRootIdentifier << std::endl;
+                        os << "\t\tSystem ID Extension: " << std::dec << int(stp_data.rootIdentifier.systemIDExtension) << std::endl;
+                        uint64_t reversedSystemID = reverseBytes48(stp_data.rootIdentifier.systemID);
+                        // Only print the 6 bytes first of the system ID
+                        os << "\t\tSystem ID: " << std::hex << std::setfill('0');
+                        os << std::setw(2) << ((reversedSystemID >> 40) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedSystemID >> 32) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedSystemID >> 24) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedSystemID >> 16) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedSystemID >> 8) & 0xFF) << ":";
+                        os << std::setw(2) << (reversedSystemID & 0xFF) << std::endl;
 
-                    os << "\tBridge Identifier:" << std::endl;
-                    uint16_t reversedBridgeIdentifier = reverseBytes16(stp_data->bridgeIdentifier.priority);
-                    os << "\t\tPriority: " << std::dec << reversedBridgeIdentifier << std::endl;
-                    os << "\t\tSystem ID Extension: " << std::dec << int(stp_data->bridgeIdentifier.systemIDExtension) << std::endl;
-                    uint64_t reversedBridgeSystemID = reverseBytes48(stp_data->bridgeIdentifier.systemID);
-                    // Only print the 6 bytes first of the system ID
-                    os << "\t\tSystem ID: " << std::hex << std::setfill('0');
-                    os << std::setw(2) << ((reversedBridgeSystemID >> 40) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedBridgeSystemID >> 32) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedBridgeSystemID >> 24) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedBridgeSystemID >> 16) & 0xFF) << ":";
-                    os << std::setw(2) << ((reversedBridgeSystemID >> 8) & 0xFF) << ":";
-                    os << std::setw(2) << (reversedBridgeSystemID & 0xFF) << std::endl;
-                }
+                        os << "\tBridge Identifier:" << std::endl;
+                        uint16_t reversedBridgeIdentifier = reverseBytes16(stp_data.bridgeIdentifier.priority);
+                        os << "\t\tPriority: " << std::dec << reversedBridgeIdentifier << std::endl;
+                        os << "\t\tSystem ID Extension: " << std::dec << int(stp_data.bridgeIdentifier.systemIDExtension) << std::endl;
+                        uint64_t reversedBridgeSystemID = reverseBytes48(stp_data.bridgeIdentifier.systemID);
+                        // Only print the 6 bytes first of the system ID
+                        os << "\t\tSystem ID: " << std::hex << std::setfill('0');
+                        os << std::setw(2) << ((reversedBridgeSystemID >> 40) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedBridgeSystemID >> 32) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedBridgeSystemID >> 24) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedBridgeSystemID >> 16) & 0xFF) << ":";
+                        os << std::setw(2) << ((reversedBridgeSystemID >> 8) & 0xFF) << ":";
+                        os << std::setw(2) << (reversedBridgeSystemID & 0xFF) << std::endl;
+                    },
+                    // The other protocols are not printed
+                    [](const ProtocolData&) {},
+                }, observation);
             }
         }
+
         return os;
     }
 
   private:
-    pcpp::IPAddress ip_address;
+    static constexpr uint32_t NoIndex = ~uint32_t(0);
+
     pcpp::MacAddress mac_address;
-    std::string host_name;
-    // First time seen
-    timespec first_seen;
-    // Last time seen
-    timespec last_seen;
-    // Array to store the protocols infos 
-    std::array<std::set<std::unique_ptr<ProtocolData>, ProtocolDataComparator>, 8> protocols_data;
+    // Protocols with a history, bit i for ProtocolType i
+    uint8_t protocols = 0;
+    // JSON materialization state, maintained by the HostManager
+    bool dirty = false;
+    // IPv4 address as pcpp::IPv4Address::toInt(), 0 if unknown
+    uint32_t ipv4 = 0;
+    // First and last time seen, realtime seconds
+    uint32_t first_seen = 0;
+    uint32_t last_seen = 0;
+    InternedString host_name;
+    uint32_t json_index = NoIndex;
+    // Sequence number of the last update of the host
+    uint64_t sequence = 0;
+    // Aging timer state, maintained by the HostManager
+    int64_t expiry = 0;
+    // Interfaces the host was seen on, in name order
+    std::pmr::vector<InternedString> interfaces;
+    // Bounded history of the observations of each protocol in protocols, in protocol order
+    std::pmr::vector<ObservationHistory> histories;
+
+    // Position of the history of a protocol in histories, whether it exists or not
+    size_t historyIndex(ProtocolType protocol) const {
+        return __builtin_popcount(protocols & ((1u << static_cast<unsigned>(protocol)) - 1));
+    }
+    bool hasHistory(ProtocolType protocol) const { return protocols & (1u << static_cast<unsigned>(protocol)); }
+    // History of a protocol, added in place if the host has none yet
+    ObservationHistory& historyOf(ProtocolType protocol);
+    // Take the histories of another host, copied into this resource if it differs
+    void moveHistories(std::pmr::vector<ObservationHistory>& from);
 
     // Delete copy constructor and copy assignment operator
     Host(const Host&) = delete;
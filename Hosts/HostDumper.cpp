@@ -0,0 +1,231 @@
+#include "HostDumper.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool writeFileAtomically(const std::string& path, const std::string& contents) {
+    // The temporary file must be on the same filesystem for rename() to be atomic
+    std::string temporary = path + ".XXXXXX";
+    int fd = mkstemp(&temporary[0]);
+    if (fd < 0) {
+        std::cerr << "Error: Unable to create " << temporary << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    fchmod(fd, 0644);
+
+    size_t written = 0;
+    while (written < contents.size()) {
+        ssize_t count = write(fd, contents.data() + written, contents.size() - written);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        written += count;
+    }
+    bool ok = written == contents.size() && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: Unable to write " << path << ": " << std::strerror(errno) << std::endl;
+        unlink(temporary.c_str());
+        return false;
+    }
+
+    // Persist the rename itself
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int directoryFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directoryFd >= 0) {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+    return true;
+}
+
+HostDumper::Result HostDumper::dump(const std::string& path, const HostSnapshots& snapshots) {
+    auto start = std::chrono::steady_clock::now();
+    Result result;
+    Json::Value hostsJson(Json::arrayValue);
+    for (const auto& snapshot : snapshots.shards) {
+        snapshot->forEach([&hostsJson](uint64_t, const Json::Value& host) {
+            hostsJson.append(host);
+        });
+    }
+    result.hosts = hostsJson.size();
+
+    Json::StreamWriterBuilder builder;
+    std::string contents = Json::writeString(builder, hostsJson);
+    result.bytes = contents.size();
+    result.written = writeFileAtomically(path, contents);
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+HostDumper::Result HostDumper::appendJournal(const std::string& path, const HostSnapshots& snapshots,
+                                             uint64_t sequence) {
+    auto start = std::chrono::steady_clock::now();
+    Result result;
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::string lines;
+    for (const auto& snapshot : snapshots.shards) {
+        if (snapshot->lastSequence <= sequence) {
+            continue;
+        }
+        snapshot->forEach([&](uint64_t hostSequence, const Json::Value& host) {
+            if (hostSequence > sequence) {
+                lines += Json::writeString(builder, host);
+                lines += '\n';
+                result.hosts++;
+            }
+        });
+        for (const HostSnapshot::Expired& tombstone : *snapshot->expired) {
+            if (tombstone.sequence > sequence) {
+                lines += Json::writeString(builder, *tombstone.record);
+                lines += '\n';
+            }
+        }
+    }
+    Json::Value watermark;
+    watermark["WATERMARK"] = Json::UInt64(snapshots.completeSequence);
+    lines += Json::writeString(builder, watermark);
+    lines += '\n';
+    result.bytes = lines.size();
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Unable to open " << path << ": " << std::strerror(errno) << std::endl;
+        return result;
+    }
+    size_t written = 0;
+    while (written < lines.size()) {
+        ssize_t count = write(fd, lines.data() + written, lines.size() - written);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        written += count;
+    }
+    result.written = written == lines.size() && fsync(fd) == 0;
+    if (!result.written) {
+        std::cerr << "Error: Unable to write " << path << ": " << std::strerror(errno) << std::endl;
+    }
+    close(fd);
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+void HostDumper::dumpAsync() {
+    if (pending.exchange(true)) {
+        return;
+    }
+    boost::asio::post(ioContext, [this]() {
+        pending = false;
+        dumpNow(source(), true);
+    });
+}
+
+void HostDumper::setAutosave(std::chrono::seconds interval, uint64_t changes) {
+    boost::asio::post(ioContext, [this, interval, changes]() {
+        autosaveInterval = interval;
+        autosaveChanges = changes;
+        timer.cancel();
+        if (interval.count() > 0 || changes > 0) {
+            scheduleAutosave();
+        }
+    });
+}
+
+void HostDumper::setJournal(const std::string& path, std::chrono::seconds interval) {
+    boost::asio::post(ioContext, [this, path, interval]() {
+        journalPath = path;
+        fullInterval = interval;
+    });
+}
+
+void HostDumper::stop() {
+    boost::asio::post(ioContext, [this]() {
+        autosaveInterval = std::chrono::seconds(0);
+        autosaveChanges = 0;
+        timer.cancel();
+    });
+}
+
+void HostDumper::dumpNow(const HostSnapshots& snapshots, bool full) {
+    auto now = std::chrono::steady_clock::now();
+    // The journal is compacted into a full report once replaying it costs more than reading the report
+    full = full || journalPath.empty() || !fullWritten || journalBytes > fullBytes ||
+           (fullInterval.count() > 0 && now - lastFullDump >= fullInterval);
+    // Evictions whose tombstone is gone since the last dump only show in a full report
+    for (const auto& snapshot : snapshots.shards) {
+        full = full || snapshot->droppedExpired > dumpedSequence;
+    }
+
+    Result result = full ? dump(path, snapshots) : appendJournal(journalPath, snapshots, dumpedSequence);
+    if (!result.written) {
+        return;
+    }
+    if (full) {
+        fullWritten = true;
+        lastFullDump = now;
+        fullBytes = result.bytes;
+        journalBytes = 0;
+        // The report holds every record of the journal, start it over from the watermark of the report
+        if (!journalPath.empty()) {
+            Json::Value watermark;
+            watermark["WATERMARK"] = Json::UInt64(snapshots.completeSequence);
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            writeFileAtomically(journalPath, Json::writeString(builder, watermark) + "\n");
+        }
+    } else {
+        journalBytes += result.bytes;
+    }
+    dumpedChanges = countChanges(snapshots);
+    dumpedSequence = std::max(dumpedSequence, snapshots.completeSequence);
+    lastDump = now;
+    std::cout << (full ? "Hosts dumped to " + path + ": " : "Hosts journaled to " + journalPath + ": ")
+              << result.hosts << (full ? " hosts, " : " changed hosts, ") << result.bytes << " bytes in "
+              << result.elapsed.count() / 1000.0 << " ms, sequence " << dumpedSequence << std::endl;
+}
+
+void HostDumper::scheduleAutosave() {
+    timer.expires_after(std::chrono::seconds(1));
+    timer.async_wait([this](const boost::system::error_code& error) {
+        if (error) {
+            // Cancelled by stop() or a new configuration
+            return;
+        }
+        checkAutosave();
+        scheduleAutosave();
+    });
+}
+
+void HostDumper::checkAutosave() {
+    HostSnapshots snapshots = source();
+    uint64_t changes = countChanges(snapshots) - dumpedChanges;
+    if (changes == 0) {
+        return;
+    }
+    bool intervalElapsed = autosaveInterval.count() > 0 && std::chrono::steady_clock::now() - lastDump >= autosaveInterval;
+    bool enoughChanges = autosaveChanges > 0 && changes >= autosaveChanges;
+    if (intervalElapsed || enoughChanges) {
+        dumpNow(snapshots, false);
+    }
+}
+
+uint64_t HostDumper::countChanges(const HostSnapshots& snapshots) {
+    uint64_t changes = 0;
+    for (const auto& snapshot : snapshots.shards) {
+        changes += snapshot->changes;
+    }
+    return changes;
+}
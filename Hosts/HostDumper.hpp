@@ -0,0 +1,115 @@
+#ifndef HOST_DUMPER_HPP
+#define HOST_DUMPER_HPP
+
+#include "HostSnapshot.hpp"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Replaces a file with new contents, so that readers see either the old or the new file.
+ *
+ * The contents are written to a temporary file in the same directory, flushed to disk with
+ * fsync, then renamed over the destination and the directory entry is flushed in turn.
+ *
+ * @param path The file to replace.
+ * @param contents The new contents of the file.
+ * @return true if the file was replaced, false if it was left untouched.
+ */
+bool writeFileAtomically(const std::string& path, const std::string& contents);
+
+/**
+ * @class HostDumper
+ *
+ * @brief Writes the hosts report from the io_context thread, on request or automatically.
+ *
+ * A dump takes the host snapshots without blocking the analysis, serializes them and replaces
+ * the report file atomically, so that the capture and the signal handling never wait on the
+ * disk. Requests made while a dump is pending are merged into it.
+ *
+ * Autosave checks the snapshots once per second and dumps when the hosts changed since the
+ * last dump and either the interval elapsed or the number of host updates reached the
+ * threshold.
+ *
+ * With a journal, autosave appends only the hosts updated since the last dump to a JSON Lines
+ * file, one host record with its SEQUENCE per line, instead of rewriting the whole report.
+ * A full report is still written on request, every full dump interval and once the journal
+ * outgrows the last full report; the journal is emptied once the full report is in place.
+ * Every batch of records is closed by a {"WATERMARK": W} line: every update numbered up to W
+ * is in the report or in the journal lines above. A consumer at watermark N reads the records
+ * with a SEQUENCE past N and moves to the last watermark it read; a record may be read twice,
+ * the one with the highest SEQUENCE for a host is current, and a record with "EXPIRED": true
+ * means the host was evicted. After a full dump the journal only holds the watermark of the
+ * report.
+ */
+class HostDumper {
+  public:
+    // Snapshots of the host shards to dump, called on the io_context thread
+    using SnapshotSource = std::function<HostSnapshots()>;
+
+    struct Result {
+        bool written = false;
+        size_t hosts = 0;
+        size_t bytes = 0;
+        std::chrono::microseconds elapsed{0};
+    };
+
+    HostDumper(boost::asio::io_context& ioContext, std::string path, SnapshotSource source)
+        : ioContext(ioContext), timer(ioContext), path(std::move(path)), source(std::move(source)) {}
+
+    HostDumper(const HostDumper&) = delete;
+    HostDumper& operator=(const HostDumper&) = delete;
+
+    // Any thread: queue a full dump on the io_context thread, merged with one already pending
+    void dumpAsync();
+    // Dump every interval and every number of host updates, 0 disables a trigger
+    void setAutosave(std::chrono::seconds interval, uint64_t changes);
+    // Autosave to a journal of the changed hosts, with a full dump at least every fullInterval
+    void setJournal(const std::string& journalPath, std::chrono::seconds fullInterval);
+    // Cancel autosave
+    void stop();
+
+    // Serialize the snapshots into the report file from the calling thread
+    static Result dump(const std::string& path, const HostSnapshots& snapshots);
+    // Append the hosts updated after a sequence number and the new watermark to a journal from the calling thread
+    static Result appendJournal(const std::string& path, const HostSnapshots& snapshots,
+                                uint64_t sequence);
+
+  private:
+    // io_context thread: dump the current snapshots, to the journal unless full, and report the outcome
+    void dumpNow(const HostSnapshots& snapshots, bool full);
+    // io_context thread: check the autosave triggers, then wait for the next check
+    void scheduleAutosave();
+    void checkAutosave();
+
+    static uint64_t countChanges(const HostSnapshots& snapshots);
+
+    boost::asio::io_context& ioContext;
+    boost::asio::steady_timer timer;
+    std::string path;
+    SnapshotSource source;
+    std::atomic<bool> pending{false};
+
+    // Autosave triggers and the state of the last dump, only used on the io_context thread
+    std::chrono::seconds autosaveInterval{0};
+    uint64_t autosaveChanges = 0;
+    uint64_t dumpedChanges = 0;
+    std::chrono::steady_clock::time_point lastDump = std::chrono::steady_clock::now();
+
+    // Journal, empty when disabled, and the state of the files, only used on the io_context thread
+    std::string journalPath;
+    std::chrono::seconds fullInterval{0};
+    bool fullWritten = false;
+    std::chrono::steady_clock::time_point lastFullDump;
+    size_t fullBytes = 0;
+    size_t journalBytes = 0;
+    uint64_t dumpedSequence = 0;
+};
+
+#endif // HOST_DUMPER_HPP
@@ -1,113 +1,338 @@
 #include "HostManager.hpp"
-#include <boost/algorithm/string.hpp>
+#include "HostDumper.hpp"
+#include <algorithm>
 #include <ctime>
-#include <fstream>
 #include <iostream>
 
-void HostManager::updateHostJson(const Host& host) {
-    for (Json::ArrayIndex i = 0; i < hostsJson.size(); ++i) {
-        std::vector<std::string> mac_address;
-        boost::split(mac_address, hostsJson[i]["MAC"].asString(), boost::is_any_of(" "));
+void HostManager::markDirty(Host& host, uint64_t key) {
+    next.changes++;
+    host.setSequence(sequence->fetch_add(1, std::memory_order_relaxed) + 1);
+    if (!host.isDirty()) {
+        host.setDirty(true);
+        dirtyHosts.push_back(key);
+    }
+}
 
-        if (mac_address[0] == boost::to_upper_copy(host.getMACAddress().toString())) {
-            hostsJson[i] = host.toJson();
-            return;
-        }
+HostSnapshot::Page& HostManager::writablePage(size_t index) {
+    size_t page = index / HostSnapshot::PageSize;
+    if (page == pages.size()) {
+        pages.push_back(std::make_shared<HostSnapshot::Page>());
+        pageShared.push_back(false);
+        writtenPages.push_back(page);
+    } else if (pageShared[page]) {
+        // Published snapshots still read the page, write to a copy
+        pages[page] = std::make_shared<HostSnapshot::Page>(*pages[page]);
+        pageShared[page] = false;
+        writtenPages.push_back(page);
     }
-    hostsJson.append(host.toJson());
+    return *pages[page];
+}
+
+void HostManager::materialize(Host& host) {
+    // A new JSON value, the previous one may still be read through an older snapshot
+    auto hostJson = std::make_shared<const Json::Value>(host.toJson());
+    size_t index = host.getJsonIndex();
+    if (index == Host::NoJsonIndex) {
+        index = next.count++;
+        host.setJsonIndex(index);
+    }
+    HostSnapshot::Page& page = writablePage(index);
+    size_t slot = index % HostSnapshot::PageSize;
+    page.keys[slot] = HostTable::key(host.getMACAddress());
+    page.sequences[slot] = host.getSequence();
+    page.hosts[slot] = std::move(hostJson);
+    next.lastSequence = std::max(next.lastSequence, host.getSequence());
+    host.setDirty(false);
+}
+
+void HostManager::updateHost(Observation observation) {
+    storeObservation(std::move(observation), false);
+}
+
+void HostManager::replayObservation(Observation observation) {
+    storeObservation(std::move(observation), true);
 }
 
-void HostManager::updateHost(ProtocolType protocol, std::unique_ptr<ProtocolData> data) {
-    timespec first_seen, last_seen;
+void HostManager::storeObservation(Observation&& observation, bool replayed) {
+    timespec seen;
+    ProtocolData& data = dataOf(observation);
+    if (data.ingress.empty()) {
+        data.ingress = ingress;
+    }
 
-    auto processHost = [&](pcpp::MacAddress mac, pcpp::IPAddress ip, const std::string& hostname, ProtocolType type) {
-        // If the host does not exists in the hostMap
-        if (hostMap.find(mac) != hostMap.end()) {
-            Host& host = hostMap[mac];
-            host.updateProtocolData(type, std::move(data));
+    // The hostname refers into the observation, it is read before the observation is moved to the host
+    auto processHost = [&](pcpp::MacAddress mac, pcpp::IPAddress ip, const std::string& hostname) {
+        // Single probe, the host is inserted if it does not exist in the hostMap
+        if (observationLog && !replayed) {
+            observationLog->append(observation);
+        }
+        // Like the restored hosts, a replayed observation lives for a full lifetime from now,
+        // but the host was seen when the observation was logged
+        clock_gettime(CLOCK_REALTIME, &seen);
+        int64_t now = seen.tv_sec;
+        // A replayed observation was captured on the interface it logged, read before the observation is moved
+        const InternedString& interface = replayed ? data.ingress : ingress;
+        if (replayed) {
+            seen = data.timestamp;
+        }
+        uint32_t lifetime = agingPolicy.lifetime(protocolOf(observation), data.ttl);
+        data.expiresAt = lifetime != 0 ? now + lifetime : 0;
+        int64_t expiresAt = data.expiresAt;
+        uint64_t key = HostTable::key(mac);
+        auto [slot, inserted] = hostMap.findOrInsert(key);
+        if (!inserted) {
+            Host& host = *slot;
+            if (!interface.empty()) host.addInterface(interface);
+            host.updateProtocolData(std::move(observation));
             if (!ip.isZero()) host.setIPAddress(ip);
-            clock_gettime(CLOCK_REALTIME, &last_seen);
-            host.setLastSeen(last_seen);
-            updateHostJson(host);
+            // The log may replay observations older than the restored host
+            if (!replayed || seen.tv_sec > host.getLastSeen().tv_sec) host.setLastSeen(seen);
+            if (replayed && seen.tv_sec < host.getFirstSeen().tv_sec) host.setFirstSeen(seen);
+            markDirty(host, key);
         } else {
-            Host host(mac, ip, hostname);
-            clock_gettime(CLOCK_REALTIME, &first_seen);
-            host.setFirstSeen(first_seen);
-            host.setLastSeen(first_seen);
-            host.updateProtocolData(type, std::move(data));
-            hostsJson.append(host.toJson());
-            hostMap[mac] = std::move(host);
+            Host host(mac, ip, hostname, timespec(), timespec(), &pool);
+            host.setFirstSeen(seen);
+            host.setLastSeen(seen);
+            if (!interface.empty()) host.addInterface(interface);
+            host.updateProtocolData(std::move(observation));
+            *slot = std::move(host);
+            markDirty(*slot, key);
         }
+        scheduleExpiry(*slot, key, expiresAt, now);
     };
 
-    switch (protocol) {
-        case ProtocolType::ARP: {
-            ARPData* arpData = dynamic_cast<ARPData*>(data.get());
-            if (arpData) {
-                processHost(arpData->senderMac, arpData->senderIp, "", ProtocolType::ARP);
-            }
-            break;
-        }
-        case ProtocolType::DHCP: {
-            DHCPData* dhcpData = dynamic_cast<DHCPData*>(data.get());
-            if (dhcpData) {
-                processHost(dhcpData->clientMac, dhcpData->ipAddress, dhcpData->hostname, ProtocolType::DHCP);
-            }
-            break;
+    visitObservation(Overloaded{
+        [&](const ARPData& arpData) { processHost(arpData.senderMac, arpData.senderIp, ""); },
+        [&](const DHCPData& dhcpData) { processHost(dhcpData.clientMac, dhcpData.ipAddress, dhcpData.hostname); },
+        [&](const STPData& stpData) { processHost(stpData.senderMAC, pcpp::IPv4Address::Zero, ""); },
+        [&](const LLDPData& lldpData) { processHost(lldpData.senderMAC, pcpp::IPv4Address::Zero, lldpData.systemName); },
+        [&](const SSDPData& ssdpData) { processHost(ssdpData.senderMAC, ssdpData.senderIP, ""); },
+        [&](const CDPData& cdpData) { processHost(cdpData.senderMAC, cdpData.senderIP, ""); },
+        [&](const WOLData& wolData) { processHost(wolData.senderMAC, pcpp::IPv4Address::Zero, ""); },
+        // mDNS answers are not attached to hosts
+        [](const mDNSData&) {},
+    }, observation);
+}
+
+void HostManager::refreshObservation(Host& host, uint64_t key, Observation& kept, pcpp::IPAddress ip,
+                                     const timespec& timestamp, uint32_t ttl) {
+    ProtocolData& data = dataOf(kept);
+    data.timestamp = timestamp;
+    if (data.ingress != ingress) {
+        data.ingress = ingress;
+    }
+    data.ttl = ttl;
+    if (data.hits != UINT32_MAX) {
+        data.hits++;
+    }
+    // Logged as the observation of the frame would be, the fields are equal
+    if (observationLog) {
+        observationLog->append(kept);
+    }
+    timespec seen;
+    clock_gettime(CLOCK_REALTIME, &seen);
+    uint32_t lifetime = agingPolicy.lifetime(protocolOf(kept), ttl);
+    data.expiresAt = lifetime != 0 ? seen.tv_sec + lifetime : 0;
+    if (!ingress.empty()) host.addInterface(ingress);
+    if (!ip.isZero()) host.setIPAddress(ip);
+    host.setLastSeen(seen);
+    markDirty(host, key);
+    scheduleExpiry(host, key, data.expiresAt, seen.tv_sec);
+}
+
+pcpp::MacAddress HostManager::observedMac(const Observation& observation) {
+    // Same addresses as updateHost() keys the hosts on
+    return visitObservation(Overloaded{
+        [](const ARPData& arpData) { return arpData.senderMac; },
+        [](const DHCPData& dhcpData) { return dhcpData.clientMac; },
+        [](const STPData& stpData) { return stpData.senderMAC; },
+        [](const LLDPData& lldpData) { return lldpData.senderMAC; },
+        [](const SSDPData& ssdpData) { return ssdpData.senderMAC; },
+        [](const CDPData& cdpData) { return cdpData.senderMAC; },
+        [](const WOLData& wolData) { return wolData.senderMAC; },
+        [](const mDNSData&) { return pcpp::MacAddress::Zero; },
+    }, observation);
+}
+
+void HostManager::restoreHost(Host&& host) {
+    uint64_t key = HostTable::key(host.getMACAddress());
+    auto [slot, inserted] = hostMap.findOrInsert(key);
+    // A host already known keeps its slot of the snapshot
+    size_t jsonIndex = inserted ? Host::NoJsonIndex : slot->getJsonIndex();
+    bool queued = !inserted && slot->isDirty();
+    *slot = std::move(host);
+    slot->setJsonIndex(jsonIndex);
+    slot->setDirty(true);
+    if (!queued) {
+        dirtyHosts.push_back(key);
+    }
+    next.changes++;
+
+    // Expiry dates are not stored: the restored observations live for a full lifetime from now
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    int64_t earliest = 0;
+    slot->setExpiry(0);
+    slot->forEachProtocolData([&](Observation& observation) {
+        ProtocolData& data = dataOf(observation);
+        uint32_t lifetime = agingPolicy.lifetime(protocolOf(observation), data.ttl);
+        data.expiresAt = lifetime != 0 ? now.tv_sec + lifetime : 0;
+        if (data.expiresAt != 0 && (earliest == 0 || data.expiresAt < earliest)) {
+            earliest = data.expiresAt;
         }
-        case ProtocolType::STP: {
-            STPData* stpData = dynamic_cast<STPData*>(data.get());
-            if (stpData) {
-                processHost(stpData->senderMAC, pcpp::IPv4Address::Zero, "", ProtocolType::STP);
-            }
-            break;
+    });
+    scheduleExpiry(*slot, key, earliest, now.tv_sec);
+}
+
+void HostManager::scheduleExpiry(Host& host, uint64_t key, int64_t expiresAt, int64_t now) {
+    // A timer due earlier reschedules itself for the later expiries when it fires
+    if (expiresAt == 0 || (host.getExpiry() != 0 && host.getExpiry() <= expiresAt)) {
+        return;
+    }
+    host.setExpiry(expiresAt);
+    timers.schedule(key, expiresAt, now);
+}
+
+void HostManager::expireHosts(int64_t now) {
+    timers.advance(now, [this, now](uint64_t key, int64_t deadline) {
+        Host* host = hostMap.find(key);
+        // Timers of evicted hosts, or superseded by an earlier one, are ignored
+        if (host == nullptr || host->getExpiry() != deadline) {
+            return;
         }
-        case ProtocolType::LLDP: {
-            LLDPData* lldpData = dynamic_cast<LLDPData*>(data.get());
-            if (lldpData) {
-                processHost(lldpData->senderMAC, pcpp::IPv4Address::Zero, lldpData->systemName, ProtocolType::LLDP);
-            }
-            break;
+        int64_t nextExpiry;
+        size_t expired = host->expireProtocolData(now, nextExpiry);
+        expiredObservations.fetch_add(expired, std::memory_order_relaxed);
+        host->setExpiry(0);
+        if (!host->hasProtocolData()) {
+            evict(*host, key);
+            return;
         }
-        case ProtocolType::SSDP: {
-            SSDPData* ssdpData = dynamic_cast<SSDPData*>(data.get());
-            if (ssdpData) {
-                processHost(ssdpData->senderMAC, ssdpData->senderIP, "", ProtocolType::SSDP);
-            }
-            break;
+        if (expired != 0) {
+            markDirty(*host, key);
         }
-        case ProtocolType::CDP: {
-            CDPData* cdpData = dynamic_cast<CDPData*>(data.get());
-            if (cdpData) {
-                processHost(cdpData->senderMAC, cdpData->senderIP, "", ProtocolType::CDP);
+        scheduleExpiry(*host, key, nextExpiry, now);
+    });
+    scheduledTimers.store(timers.size(), std::memory_order_relaxed);
+}
+
+void HostManager::evict(Host& host, uint64_t key) {
+    // Move the last host of the next snapshot into the slot of the evicted one
+    size_t index = host.getJsonIndex();
+    if (index != Host::NoJsonIndex) {
+        size_t last = next.count - 1;
+        HostSnapshot::Page& lastPage = writablePage(last);
+        size_t lastSlot = last % HostSnapshot::PageSize;
+        if (index != last) {
+            HostSnapshot::Page& page = writablePage(index);
+            size_t slot = index % HostSnapshot::PageSize;
+            page.keys[slot] = lastPage.keys[lastSlot];
+            page.sequences[slot] = lastPage.sequences[lastSlot];
+            page.hosts[slot] = std::move(lastPage.hosts[lastSlot]);
+            if (Host* moved = hostMap.find(page.keys[slot])) {
+                moved->setJsonIndex(index);
             }
-            break;
         }
-        case ProtocolType::WOL: {
-            WOLData* wolData = dynamic_cast<WOLData*>(data.get());
-            if (wolData) {
-                processHost(wolData->senderMAC, pcpp::IPv4Address::Zero, "", ProtocolType::WOL);
-            }
-            break;
+        lastPage.hosts[lastSlot].reset();
+        if (--next.count % HostSnapshot::PageSize == 0) {
+            pages.pop_back();
+            pageShared.pop_back();
         }
     }
+
+    uint64_t tombstoneSequence = sequence->fetch_add(1, std::memory_order_relaxed) + 1;
+    Json::Value tombstone;
+    tombstone["MAC"] = pcppMACAddressToString(host.getMACAddress(), vendorDatabase);
+    tombstone["EXPIRED"] = true;
+    tombstone["LAST SEEN"] = host.dateToString(host.getLastSeen());
+    tombstone["SEQUENCE"] = Json::UInt64(tombstoneSequence);
+    tombstones.push_back({tombstoneSequence, std::make_shared<const Json::Value>(std::move(tombstone))});
+    next.lastSequence = std::max(next.lastSequence, tombstoneSequence);
+    next.changes++;
+    evictionsPending = true;
+
+    // A pending re-serialization of the host finds it gone and is skipped
+    hostMap.erase(key);
+    evictedHosts.fetch_add(1, std::memory_order_relaxed);
+}
+
+HostManager::AgingStats HostManager::getAgingStats() const {
+    AgingStats stats;
+    stats.expiredObservations = expiredObservations.load(std::memory_order_relaxed);
+    stats.evictedHosts = evictedHosts.load(std::memory_order_relaxed);
+    stats.scheduledTimers = scheduledTimers.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void HostManager::dumpHostsToFile(const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error opening file!" << std::endl;
-        return;
+    auto published = publishSnapshot();
+    HostDumper::dump(filename, {getPublishedSequence(), {published}});
+}
+
+const HostTable& HostManager::getHostMap() const {
+    return hostMap;
+}
+
+std::shared_ptr<const HostSnapshot> HostManager::publishSnapshot() {
+    // The later updates of this HostManager will be numbered past the counter
+    uint64_t complete = sequence->load(std::memory_order_relaxed);
+    if (dirtyHosts.empty() && !evictionsPending) {
+        publishedSequence.store(complete, std::memory_order_release);
+        return getSnapshot();
+    }
+    for (uint64_t key : dirtyHosts) {
+        Host* host = hostMap.find(key);
+        if (host != nullptr && host->isDirty()) {
+            materialize(*host);
+        }
+    }
+    dirtyHosts.clear();
+    if (evictionsPending) {
+        if (tombstones.size() > HostSnapshot::MaxExpired) {
+            size_t excess = tombstones.size() - HostSnapshot::MaxExpired;
+            next.droppedExpired = tombstones[excess - 1].sequence;
+            tombstones.erase(tombstones.begin(), tombstones.begin() + excess);
+        }
+        next.expired = std::make_shared<const std::vector<HostSnapshot::Expired>>(tombstones);
+        evictionsPending = false;
     }
 
-    file << hostsJson;
-    file.close();
+    // Copy the page pointers, the pages without a changed host are shared with the previous snapshot
+    next.generation++;
+    auto published = std::make_shared<HostSnapshot>(next);
+    published->pages.assign(pages.begin(), pages.end());
+    for (size_t page : writtenPages) {
+        if (page < pageShared.size()) {
+            pageShared[page] = true;
+        }
+    }
+    writtenPages.clear();
+    std::shared_ptr<const HostSnapshot> readable = std::move(published);
+    std::atomic_store_explicit(&snapshot, readable, std::memory_order_release);
+    publishedSequence.store(complete, std::memory_order_release);
+    return readable;
+}
+
+std::shared_ptr<const HostSnapshot> HostManager::getSnapshot() const {
+    return std::atomic_load_explicit(&snapshot, std::memory_order_acquire);
 }
 
-const Json::Value& HostManager::getHostsJson() const {
-    return hostsJson;
+Json::Value HostManager::getHostsJson() {
+    return publishSnapshot()->toJson();
+}
+
+Json::Value HostManager::getHostJson(const pcpp::MacAddress& mac) {
+    std::shared_ptr<const HostSnapshot> published = publishSnapshot();
+    // Every host of the table is materialized by the publication, at its JSON index
+    uint64_t key = HostTable::key(mac);
+    const Host* host = hostMap.find(key);
+    if (host == nullptr || host->getJsonIndex() == Host::NoJsonIndex) {
+        return Json::Value();
+    }
+    const Json::Value* hostJson = published->find(key, host->getJsonIndex());
+    return hostJson != nullptr ? *hostJson : Json::Value();
 }
 
 void HostManager::printHostMap() {
-    std::cout << hostsJson << std::endl;
+    std::cout << getHostsJson() << std::endl;
 }
@@ -2,6 +2,16 @@
 #define HOST_MANAGER_HPP
 
 #include "Host.hpp"
+#include "HostTable.hpp"
+#include "HostSnapshot.hpp"
+#include "ObservationLog.hpp"
+#include "SlabResource.hpp"
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
 
 /**
  * @class MacAddressHash
@@ -10,8 +20,8 @@
  */
 struct MacAddressHash {
     std::size_t operator()(const pcpp::MacAddress& mac) const {
-        // Example hash implementation based on the byte array representation of the MAC address
-        return std::hash<std::string>()(mac.toString());
+        // Hash the address packed in 48 bits, without formatting it
+        return std::hash<uint64_t>()(HostTable::key(mac));
     }
 };
 
@@ -33,8 +43,17 @@ struct MacAddressEqual {
  */
 struct IPAddressHash {
     std::size_t operator()(const pcpp::IPAddress& ip) const {
-        // Example hash implementation based on the byte array representation of the IP address
-        return std::hash<std::string>()(ip.toString());
+        // Hash the raw address bytes, without formatting them
+        if (ip.isIPv4()) {
+            return std::hash<uint32_t>()(ip.getIPv4().toInt());
+        }
+        const uint8_t* bytes = ip.getIPv6().toBytes();
+        uint64_t high = 0, low = 0;
+        for (size_t i = 0; i < 8; i++) {
+            high = (high << 8) | bytes[i];
+            low = (low << 8) | bytes[i + 8];
+        }
+        return std::hash<uint64_t>()(high * 0x9E3779B97F4A7C15ull ^ low);
     }
 };
 
@@ -49,6 +68,33 @@ struct IPAddressEqual {
     }
 };
 
+/**
+ * @struct AgingPolicy
+ * @brief Lifetime of the observations of each protocol, after which they are removed.
+ *
+ * An observation lives for the idle timeout of its protocol after it was last seen, or for
+ * the lifetime the protocol announced with it (the LLDP TTL, the CDP holdtime, the mDNS record
+ * TTL) when TTLs are honoured. A protocol with no idle timeout is never aged out, whatever its
+ * TTL, so aging is disabled by default.
+ */
+struct AgingPolicy {
+    // Idle timeout of each protocol in seconds, indexed by ProtocolType, 0 to keep its observations
+    std::array<uint32_t, 8> idleTimeouts{};
+    bool honourTtl = true;
+
+    bool enabled() const {
+        return std::any_of(idleTimeouts.begin(), idleTimeouts.end(), [](uint32_t timeout) { return timeout != 0; });
+    }
+
+    // Seconds an observation lives after it is seen, 0 for ever
+    uint32_t lifetime(ProtocolType protocol, uint32_t ttl) const {
+        uint32_t timeout = idleTimeouts[static_cast<size_t>(protocol)];
+        if (timeout == 0) {
+            return 0;
+        }
+        return honourTtl && ttl != 0 ? ttl : timeout;
+    }
+};
 
 /**
  * @class HostManager
@@ -56,26 +102,166 @@ struct IPAddressEqual {
  * 
  * The HostManager class is responsible for managing hosts, updating their information,
  * and maintaining a JSON representation of the hosts. It provides methods to update
- * hosts with protocol-specific data, update the JSON representation, dump host information
- * to a file, print the host map, and retrieve the host map.
+ * hosts with protocol-specific data, dump host information to a file, print the host map,
+ * and retrieve the host map.
+ *
+ * The JSON representation is not maintained on the packet path: an update only marks the
+ * host dirty. The JSON is materialized when a snapshot is published, re-serializing only the
+ * hosts changed since the previous one.
+ *
+ * A HostManager has a single writer at a time: updates, publishing and the other non-const
+ * methods are called by the thread analyzing the packets, or under a lock held by the writers.
+ * Other threads only read the last published HostSnapshot through getSnapshot(), which is
+ * swapped atomically and never blocks on the writer, nor the writer on them.
+ *
+ * Every update of a host stamps it with the next number of a sequence, which can be shared
+ * by the HostManagers of several shards, so that changes can be read back incrementally.
+ *
+ * Every observation is stamped with the ingress interface set by the capture side, and each
+ * host keeps the set of interfaces it was seen on. With an ObservationLog, every accepted
+ * observation is logged before it is applied.
+ *
+ * With an AgingPolicy, every observation gets an expiry date and every host a timer on a
+ * TimerWheel, due at its earliest expiry; refreshing an observation does not touch the wheel,
+ * the timer reschedules itself when it fires early. expireHosts() removes the expired
+ * observations, and evicts the hosts left without any: the host leaves the table and the
+ * snapshot, and a tombstone numbered like an update is published in its place.
+ *
+ * The interface sets and observation histories of the hosts are allocated from a SlabResource
+ * owned by the HostManager: once warmed up, updating a known host does not touch the global
+ * heap, and the slabs emptied by the evicted hosts are handed back in bulk.
  */
 class HostManager {
 public:
+    HostManager(size_t expectedHosts = 0)
+        : hostMap(expectedHosts, &pool), snapshot(std::make_shared<const HostSnapshot>()),
+          sequence(std::make_shared<std::atomic<uint64_t>>(0)) {}
+
     // Add or update a host with information from a specific protocol
-    void updateHost(ProtocolType protocol, std::unique_ptr<ProtocolData> data);
-    // Update a host in the hostsJson array
-    void updateHostJson(const Host& host);
+    void updateHost(Observation observation);
+    // Re-apply an observation read back from the log: the host was seen at the logged timestamp
+    void replayObservation(Observation observation);
+
+    /**
+     * @brief Refreshes the latest observation of a host that a frame carries again, without building it.
+     *
+     * Does what updateHost() does with the observation of the frame when it equals the latest one the
+     * host keeps for the protocol, the usual case of a device announcing itself again: nothing is
+     * allocated for the frame. Any other frame is for updateHost().
+     *
+     * @param mac The host the frame is about.
+     * @param ip The address updateHost() would set, zero for none.
+     * @param timestamp The time the frame was captured.
+     * @param ttl The lifetime the frame announces, 0 for none.
+     * @param repeats Called with the kept observation, whether the frame carries the same data.
+     * @return false if the frame has to be built into an observation and handed to updateHost().
+     */
+    template <typename Data, typename Repeats>
+    bool refreshHost(const pcpp::MacAddress& mac, pcpp::IPAddress ip, const timespec& timestamp, uint32_t ttl, Repeats&& repeats) {
+        uint64_t key = HostTable::key(mac);
+        Host* host = hostMap.find(key);
+        Observation* latest = host != nullptr ? host->latestObservation(protocolOfData<Data>()) : nullptr;
+        if (latest == nullptr || !repeats(static_cast<const Data&>(unbox(std::get<static_cast<size_t>(protocolOfData<Data>())>(*latest))))) {
+            return false;
+        }
+        refreshObservation(*host, key, *latest, ip, timestamp, ttl);
+        return true;
+    }
     // Update report file with hosts information
     void dumpHostsToFile(const std::string& filename);
     // Print the host map	
     void printHostMap();
     // Get the host map
-    const std::unordered_map<pcpp::MacAddress, Host, MacAddressHash, MacAddressEqual>& getHostMap() const;
-    // Get the JSON representation of the hosts
-    const Json::Value& getHostsJson() const;
+    const HostTable& getHostMap() const;
+    // Pre-size the host table for the expected number of hosts
+    void reserve(size_t expectedHosts) { hostMap.reserve(expectedHosts); }
+    // Get the JSON representation of the hosts, publishing a snapshot first
+    Json::Value getHostsJson();
+    // Get the JSON representation of one host, publishing a snapshot first, null if unknown; a table lookup, not a scan
+    Json::Value getHostJson(const pcpp::MacAddress& mac);
+    // Writer side: publish the hosts changed since the last snapshot, returns the current snapshot;
+    // copies the pages of the changed hosts and one pointer per page of the others
+    std::shared_ptr<const HostSnapshot> publishSnapshot();
+    // Any thread: last published snapshot, never null
+    std::shared_ptr<const HostSnapshot> getSnapshot() const;
+    // Any thread: every update of this HostManager numbered up to it is in the published snapshot
+    uint64_t getPublishedSequence() const { return publishedSequence.load(std::memory_order_acquire); }
+    // Hosts changed or evicted since the last published snapshot
+    bool hasChanges() const { return !dirtyHosts.empty() || evictionsPending; }
+    // Draw the sequence numbers of the updates from a counter shared with other HostManagers
+    void setSequenceCounter(std::shared_ptr<std::atomic<uint64_t>> counter) { sequence = std::move(counter); }
+    // Insert a host restored from a snapshot file, keeping its sequence number
+    void restoreHost(Host&& host);
+    // Log every accepted observation ahead of the host store, nullptr to stop logging
+    void setObservationLog(ObservationLog* log) { observationLog = log ? &log->addBuffer() : nullptr; }
+    // MAC address of the host an observation is about, zero if the protocol is not stored
+    static pcpp::MacAddress observedMac(const Observation& observation);
+    // Set the interface the next observations are captured on
+    void setIngress(const InternedString& interface) {
+        if (ingress != interface) {
+            ingress = interface;
+        }
+    }
+    // Age the observations out, set before any host is added or restored
+    void setAgingPolicy(const AgingPolicy& policy) { agingPolicy = policy; }
+    // Writer side: remove the observations expired at a realtime second and evict the hosts left empty
+    void expireHosts(int64_t now);
+
+    struct AgingStats {
+        uint64_t expiredObservations = 0;
+        uint64_t evictedHosts = 0;
+        // Hosts with an aging timer, and the timers pending on the wheel
+        size_t scheduledTimers = 0;
+    };
+    // Any thread: counters of the aging, the timers as of the last expireHosts()
+    AgingStats getAgingStats() const;
+    // Any thread: counters of the memory pool of the hosts
+    SlabResource::Stats getMemoryStats() const { return pool.getStats(); }
 private:
-    std::unordered_map<pcpp::MacAddress, Host, MacAddressHash, MacAddressEqual> hostMap;
-    Json::Value hostsJson;
+    // Declared before the table, so that the hosts are destroyed before their pool
+    SlabResource pool;
+    HostTable hostMap;
+    // Keys of the hosts changed since the last snapshot
+    std::vector<uint64_t> dirtyHosts;
+    // Counters of the next snapshot, its pages and tombstones are kept apart below
+    HostSnapshot next;
+    // Pages of the next snapshot, and whether each one is shared with a published snapshot
+    std::vector<std::shared_ptr<HostSnapshot::Page>> pages;
+    std::vector<bool> pageShared;
+    // Pages written since the last snapshot, shared once it is published
+    std::vector<size_t> writtenPages;
+    // Tombstones of the next snapshot, oldest first
+    std::vector<HostSnapshot::Expired> tombstones;
+    // Published snapshot, only accessed atomically
+    std::shared_ptr<const HostSnapshot> snapshot;
+    std::atomic<uint64_t> publishedSequence{0};
+    // Source of the update sequence numbers
+    std::shared_ptr<std::atomic<uint64_t>> sequence;
+    // Interface stamped on the observations
+    InternedString ingress;
+    // This shard's buffer of the write-ahead log, committed with those of the other shards
+    ObservationLog::Buffer* observationLog = nullptr;
+    // Aging timers of the hosts, keyed by HostTable key
+    AgingPolicy agingPolicy;
+    TimerWheel timers;
+    bool evictionsPending = false;
+    std::atomic<uint64_t> expiredObservations{0};
+    std::atomic<uint64_t> evictedHosts{0};
+    std::atomic<size_t> scheduledTimers{0};
+    // Refresh a kept observation seen again, as ObservationHistory::record() and updateHost() would
+    void refreshObservation(Host& host, uint64_t key, Observation& kept, pcpp::IPAddress ip, const timespec& timestamp, uint32_t ttl);
+    // Insert or update the host of an observation, seen now or, replayed, at its timestamp
+    void storeObservation(Observation&& observation, bool replayed);
+    // Schedule the timer of a host if an observation expires before it is due
+    void scheduleExpiry(Host& host, uint64_t key, int64_t expiresAt, int64_t now);
+    // Remove a host from the table and the next snapshot, leaving a tombstone
+    void evict(Host& host, uint64_t key);
+    // Stamp a host with the next sequence number and mark it to be re-serialized
+    void markDirty(Host& host, uint64_t key);
+    // Write the JSON of a host to its slot of the next snapshot
+    void materialize(Host& host);
+    // Page of the next snapshot holding a host index, copied first if a published snapshot shares it
+    HostSnapshot::Page& writablePage(size_t index);
     // Unknown mac address counter
     int unknownMacCounter = 0;
 };
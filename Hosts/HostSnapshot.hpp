@@ -0,0 +1,120 @@
+#ifndef HOST_SNAPSHOT_HPP
+#define HOST_SNAPSHOT_HPP
+
+#include "HostTable.hpp"
+
+#include <json/json.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @class HostSnapshot
+ *
+ * @brief Immutable point-in-time view of the hosts of a HostManager.
+ *
+ * A snapshot is published by the thread updating the hosts and then only ever read, so any
+ * number of threads can read it without synchronization. The hosts are stored in fixed-size
+ * pages shared between the snapshots they did not change in: publishing a new snapshot copies
+ * the pages holding a changed host, re-serializes the changed hosts only, and copies one page
+ * pointer per PageSize hosts for the others. A snapshot is freed once its last reader releases it.
+ *
+ * Hosts evicted by aging leave the snapshot, and a tombstone record with the sequence number
+ * of the eviction is kept for the readers following the changes. Only the last MaxExpired
+ * tombstones are kept; a reader further behind reloads the full host list.
+ */
+struct HostSnapshot {
+    static constexpr size_t PageSize = 256;
+
+    // HostTable key, sequence number of the last update and JSON of PageSize hosts, indexed alike
+    struct Page {
+        std::array<uint64_t, PageSize> keys{};
+        std::array<uint64_t, PageSize> sequences{};
+        std::array<std::shared_ptr<const Json::Value>, PageSize> hosts;
+    };
+
+    // Tombstone of an evicted host
+    struct Expired {
+        uint64_t sequence;
+        std::shared_ptr<const Json::Value> record;
+    };
+    static constexpr size_t MaxExpired = 1024;
+
+    // Number of snapshots published before this one by the same HostManager
+    uint64_t generation = 0;
+    // Host updates applied before this snapshot was published
+    uint64_t changes = 0;
+    // Highest sequence number of the hosts
+    uint64_t lastSequence = 0;
+    // Host i is in slot i % PageSize of page i / PageSize, every page but the last is full
+    size_t count = 0;
+    std::vector<std::shared_ptr<const Page>> pages;
+    // Tombstones of the hosts evicted most recently, oldest first, never null
+    std::shared_ptr<const std::vector<Expired>> expired = std::make_shared<const std::vector<Expired>>();
+    // Sequence number of the last tombstone dropped from the list, 0 if none
+    uint64_t droppedExpired = 0;
+
+    size_t size() const { return count; }
+    uint64_t keyAt(size_t index) const { return pages[index / PageSize]->keys[index % PageSize]; }
+    uint64_t sequenceAt(size_t index) const { return pages[index / PageSize]->sequences[index % PageSize]; }
+    const Json::Value& hostAt(size_t index) const { return *pages[index / PageSize]->hosts[index % PageSize]; }
+
+    // Call a function with the sequence number and the JSON of every host
+    template <typename Function>
+    void forEach(Function&& function) const {
+        for (size_t first = 0; first < count; first += PageSize) {
+            const Page& page = *pages[first / PageSize];
+            for (size_t slot = 0; slot < std::min(PageSize, count - first); slot++) {
+                function(page.sequences[slot], *page.hosts[slot]);
+            }
+        }
+    }
+
+    // JSON array of the hosts
+    Json::Value toJson() const {
+        Json::Value hostsJson(Json::arrayValue);
+        forEach([&hostsJson](uint64_t, const Json::Value& host) {
+            hostsJson.append(host);
+        });
+        return hostsJson;
+    }
+
+    // JSON array of the hosts updated, then of the hosts evicted, after the given sequence number
+    Json::Value changesSince(uint64_t sequence) const {
+        Json::Value hostsJson(Json::arrayValue);
+        forEach([&hostsJson, sequence](uint64_t hostSequence, const Json::Value& host) {
+            if (hostSequence > sequence) {
+                hostsJson.append(host);
+            }
+        });
+        for (const Expired& tombstone : *expired) {
+            if (tombstone.sequence > sequence) {
+                hostsJson.append(*tombstone.record);
+            }
+        }
+        return hostsJson;
+    }
+
+    // JSON of the host with a HostTable key at an index, nullptr if the snapshot holds another one there
+    const Json::Value* find(uint64_t key, size_t index) const {
+        return index < count && keyAt(index) == key ? &hostAt(index) : nullptr;
+    }
+};
+
+/**
+ * @struct HostSnapshots
+ * @brief Snapshots of every host shard, with the sequence number up to which they are complete.
+ *
+ * The shards draw their sequence numbers from one counter but publish independently, so a
+ * shard may hold an update numbered above another shard's unpublished one. Every update
+ * numbered up to completeSequence is in the snapshots, later ones may or may not be.
+ */
+struct HostSnapshots {
+    uint64_t completeSequence = 0;
+    std::vector<std::shared_ptr<const HostSnapshot>> shards;
+};
+
+#endif // HOST_SNAPSHOT_HPP
@@ -0,0 +1,197 @@
+#ifndef HOST_TABLE_HPP
+#define HOST_TABLE_HPP
+
+#include "Host.hpp"
+
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+/**
+ * @class HostTable
+ *
+ * @brief Open-addressing hash table of hosts keyed by their MAC address.
+ *
+ * The MAC address is packed into the low 48 bits of a uint64_t, which is hashed with a
+ * multiply-xorshift mixer and looked up by linear probing. The probed table only holds the
+ * keys and, beside them, the 4-byte index of each host in a dense array of the records, so a
+ * probe sequence only walks contiguous keys and a free slot costs 12 bytes instead of a record.
+ * An update costs a single probe sequence, whether the host is found or inserted. The table
+ * doubles once it is 70% full; it can be pre-sized for the expected number of hosts to avoid
+ * rehashing on the packet path, which only moves the keys and indices, never the records.
+ *
+ * The records are compact fixed-size hosts, their histories and interfaces held apart, stored
+ * densely with their keys alongside: a scan of every host, for a snapshot or a dump, is a
+ * sequential sweep of the live hosts only. A removed host is replaced by the last one, like the
+ * snapshot pages do, so the records stay dense.
+ *
+ * Removal from the probed table uses backward-shift deletion rather than tombstones: the keys
+ * probed past the removed one are shifted back, so lookups never walk over deleted slots.
+ *
+ * Pointers to hosts are invalidated by an insertion and by a removal.
+ *
+ * Every host of the table allocates from the memory resource of the table.
+ */
+class HostTable {
+public:
+    explicit HostTable(size_t expectedHosts = 0, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource(resource) {
+        reserve(expectedHosts);
+    }
+
+    // Pack a MAC address into a table key
+    static uint64_t key(const pcpp::MacAddress& mac) {
+        uint8_t bytes[6];
+        mac.copyTo(bytes);
+        uint64_t value = 0;
+        for (size_t i = 0; i < 6; i++) {
+            value = (value << 8) | bytes[i];
+        }
+        return value;
+    }
+
+    // Find the host of a key, inserting a default one if missing; true if it was inserted
+    std::pair<Host*, bool> findOrInsert(uint64_t hostKey) {
+        if ((hosts.size() + 1) * 10 > keys.size() * 7) {
+            rehash(keys.empty() ? MinCapacity : keys.size() * 2);
+        }
+        size_t slot = probe(hostKey);
+        if (keys[slot] == hostKey) {
+            return {&hosts[indices[slot]], false};
+        }
+        hosts.emplace_back(resource);
+        hostKeys.push_back(hostKey);
+        keys[slot] = hostKey;
+        indices[slot] = static_cast<uint32_t>(hosts.size() - 1);
+        return {&hosts.back(), true};
+    }
+
+    // Find the host of a key, nullptr if missing
+    Host* find(uint64_t hostKey) {
+        if (keys.empty()) {
+            return nullptr;
+        }
+        size_t slot = probe(hostKey);
+        return keys[slot] == hostKey ? &hosts[indices[slot]] : nullptr;
+    }
+
+    const Host* find(uint64_t hostKey) const {
+        return const_cast<HostTable*>(this)->find(hostKey);
+    }
+
+    // Remove the host of a key, false if missing
+    bool erase(uint64_t hostKey) {
+        if (keys.empty()) {
+            return false;
+        }
+        size_t mask = keys.size() - 1;
+        size_t hole = probe(hostKey);
+        if (keys[hole] != hostKey) {
+            return false;
+        }
+        uint32_t index = indices[hole];
+        // Shift back every key of the cluster whose home slot does not lie between the hole and it
+        for (size_t next = (hole + 1) & mask; keys[next] != EmptyKey; next = (next + 1) & mask) {
+            size_t home = mix(keys[next]) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                keys[hole] = keys[next];
+                indices[hole] = indices[next];
+                hole = next;
+            }
+        }
+        keys[hole] = EmptyKey;
+
+        // Move the last host into the record of the removed one
+        size_t last = hosts.size() - 1;
+        if (index != last) {
+            hosts[index] = std::move(hosts[last]);
+            hostKeys[index] = hostKeys[last];
+            indices[probe(hostKeys[index])] = index;
+        }
+        hosts.pop_back();
+        hostKeys.pop_back();
+        return true;
+    }
+
+    // Grow the table so that it holds the given number of hosts without rehashing
+    void reserve(size_t expectedHosts) {
+        size_t capacity = MinCapacity;
+        while (capacity * 7 < expectedHosts * 10) {
+            capacity *= 2;
+        }
+        if (capacity > keys.size()) {
+            rehash(capacity);
+        }
+        hosts.reserve(expectedHosts);
+        hostKeys.reserve(expectedHosts);
+    }
+
+    size_t size() const { return hosts.size(); }
+    size_t capacity() const { return keys.size(); }
+    bool empty() const { return hosts.empty(); }
+    std::pmr::memory_resource* getResource() const { return resource; }
+    // Bytes of the probed table and the records, without what the hosts allocate from the resource
+    size_t memoryUsage() const {
+        return keys.capacity() * sizeof(uint64_t) + indices.capacity() * sizeof(uint32_t) +
+               hosts.capacity() * sizeof(Host) + hostKeys.capacity() * sizeof(uint64_t);
+    }
+
+    // Call a function on every host, in record order
+    template <typename Function>
+    void forEach(Function&& function) const {
+        for (const Host& host : hosts) {
+            function(host);
+        }
+    }
+
+    template <typename Function>
+    void forEach(Function&& function) {
+        for (Host& host : hosts) {
+            function(host);
+        }
+    }
+
+private:
+    // No MAC address packs to this value, it marks free slots
+    static constexpr uint64_t EmptyKey = ~uint64_t(0);
+    static constexpr size_t MinCapacity = 16;
+
+    static uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    // Slot holding the key, or the free slot where it belongs
+    size_t probe(uint64_t hostKey) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = mix(hostKey) & mask;
+        while (keys[slot] != hostKey && keys[slot] != EmptyKey) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    // Index every host in a table of the given power of two capacity, the records stay in place
+    void rehash(size_t capacity) {
+        keys.assign(capacity, EmptyKey);
+        indices.assign(capacity, 0);
+        for (size_t index = 0; index < hostKeys.size(); index++) {
+            size_t slot = probe(hostKeys[index]);
+            keys[slot] = hostKeys[index];
+            indices[slot] = static_cast<uint32_t>(index);
+        }
+    }
+
+    // Probed table: the key of each slot and the index of its host, EmptyKey for a free slot
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> indices;
+    // Records of the hosts and their keys, dense and indexed alike
+    std::vector<Host> hosts;
+    std::vector<uint64_t> hostKeys;
+    std::pmr::memory_resource* resource;
+};
+
+#endif // HOST_TABLE_HPP
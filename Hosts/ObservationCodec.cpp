@@ -0,0 +1,323 @@
+#include "ObservationCodec.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+uint64_t checksum64(const uint8_t* data, size_t length) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+        hash ^= hash >> 32;
+    }
+    for (; i < length; i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+StringTable::StringTable() {
+    // Offset 0 is the empty string
+    interned.emplace(std::string(), 0);
+}
+
+StringRef StringTable::intern(const std::string& value) {
+    auto [it, inserted] = interned.emplace(value, static_cast<uint32_t>(strings.size()));
+    if (inserted) {
+        strings += value;
+    }
+    return {it->second, static_cast<uint32_t>(value.size())};
+}
+
+StringRef StringTable::intern(const uint8_t* data, size_t length) {
+    return intern(std::string(reinterpret_cast<const char*>(data), length));
+}
+
+void ObservationWriter::putMac(const pcpp::MacAddress& mac) {
+    uint8_t bytes[6];
+    mac.copyTo(bytes);
+    out.append(reinterpret_cast<const char*>(bytes), 6);
+}
+
+void ObservationWriter::putIp(const pcpp::IPAddress& ip) {
+    if (ip.isIPv4()) {
+        out += char(4);
+        out.append(reinterpret_cast<const char*>(ip.getIPv4().toBytes()), 4);
+    } else if (ip.isIPv6()) {
+        out += char(6);
+        out.append(reinterpret_cast<const char*>(ip.getIPv6().toBytes()), 16);
+    } else {
+        out += char(0);
+    }
+}
+
+void ObservationWriter::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void ObservationWriter::putString(const std::string& value) {
+    putBytes(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+}
+
+void ObservationWriter::putBytes(const uint8_t* data, size_t length) {
+    if (table) {
+        put(table->intern(data, length));
+        return;
+    }
+    putVarint(length);
+    out.append(reinterpret_cast<const char*>(data), length);
+}
+
+void ObservationWriter::putFields(const Observation& observation) {
+    visitObservation(Overloaded{
+        [this](const DHCPData& dhcp) {
+            putMac(dhcp.clientMac);
+            putIp(dhcp.ipAddress);
+            putIp(dhcp.dhcpServerIp);
+            putIp(dhcp.gatewayIp);
+            putIp(dhcp.dnsServerIp);
+            putString(dhcp.hostname);
+        },
+        [this](const mDNSData& mdns) {
+            putString(mdns.queriedDomain);
+            putMac(mdns.clientMac);
+            putString(mdns.hostname);
+            putIp(mdns.ipAddress);
+        },
+        [this](const ARPData& arp) {
+            putMac(arp.senderMac);
+            putIp(arp.senderIp);
+            putIp(arp.targetIp);
+        },
+        [this](const SSDPData& ssdp) {
+            putMac(ssdp.senderMAC);
+            put(ssdp.senderIP.toInt());
+            put(static_cast<uint8_t>(ssdp.ssdpType));
+            put(static_cast<uint32_t>(ssdp.ssdpHeaders.size()));
+            for (const auto& header : ssdp.ssdpHeaders) {
+                putString(header.first);
+                putString(header.second);
+            }
+        },
+        [this](const LLDPData& lldp) {
+            putMac(lldp.senderMAC);
+            putString(lldp.portID);
+            putString(lldp.portDescription);
+            putString(lldp.systemName);
+            putString(lldp.systemDescription);
+        },
+        [this](const CDPData& cdp) {
+            auto putAddresses = [this](const CDPLayer::Addresses& list) {
+                put(list.numberOfAddresses);
+                put(static_cast<uint32_t>(list.addresses.size()));
+                for (const CDPLayer::Address& address : list.addresses) {
+                    put(address.protocolType);
+                    put(address.protocolLength);
+                    put(address.protocol);
+                    putBytes(address.address, address.addressLength);
+                }
+            };
+            putMac(cdp.senderMAC);
+            put(cdp.senderIP.toInt());
+            put(static_cast<uint8_t>(cdp.deviceId.subtype));
+            putString(cdp.deviceId.id);
+            putAddresses(cdp.addresses);
+            putString(cdp.portId);
+            put(cdp.capabilities);
+            putString(cdp.capabilitiesStr);
+            putString(cdp.softwareVersion);
+            putString(cdp.platform);
+            putString(cdp.vtpManagementDomain);
+            put(cdp.nativeVlan);
+            put(cdp.duplex);
+            put(cdp.trustBitmap);
+            put(cdp.untrustedPortCos);
+            putAddresses(cdp.mgmtAddresses);
+        },
+        [this](const STPData& stp) {
+            putMac(stp.senderMAC);
+            put(stp.rootIdentifier);
+            put(stp.bridgeIdentifier);
+        },
+        [this](const WOLData& wol) {
+            putMac(wol.senderMAC);
+            putMac(wol.targetMAC);
+        },
+    }, observation);
+}
+
+void ObservationReader::require(size_t count) const {
+    if (count > length - offset) {
+        throw std::out_of_range("record truncated");
+    }
+}
+
+uint64_t ObservationReader::getVarint() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = get<uint8_t>();
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw std::out_of_range("varint too long");
+}
+
+pcpp::MacAddress ObservationReader::getMac() {
+    require(6);
+    pcpp::MacAddress mac(data + offset);
+    offset += 6;
+    return mac;
+}
+
+pcpp::IPAddress ObservationReader::toIp(uint8_t version, const uint8_t* bytes) {
+    if (version == 4) {
+        return pcpp::IPv4Address(bytes);
+    }
+    if (version == 6) {
+        return pcpp::IPv6Address(bytes);
+    }
+    return pcpp::IPv4Address::Zero;
+}
+
+pcpp::IPAddress ObservationReader::getIp() {
+    uint8_t version = get<uint8_t>();
+    size_t size = version == 4 ? 4 : version == 6 ? 16 : 0;
+    require(size);
+    pcpp::IPAddress ip = toIp(version, data + offset);
+    offset += size;
+    return ip;
+}
+
+const uint8_t* ObservationReader::getBytes(size_t& count) {
+    if (tableStrings) {
+        StringRef ref = get<StringRef>();
+        resolve(ref);
+        count = ref.length;
+        return strings + ref.offset;
+    }
+    count = getVarint();
+    require(count);
+    const uint8_t* bytes = data + offset;
+    offset += count;
+    return bytes;
+}
+
+std::string ObservationReader::getString() {
+    size_t count;
+    const uint8_t* bytes = getBytes(count);
+    return std::string(reinterpret_cast<const char*>(bytes), count);
+}
+
+std::string ObservationReader::resolve(const StringRef& ref) const {
+    if (uint64_t(ref.offset) + ref.length > stringsLength) {
+        throw std::out_of_range("string reference out of the string table");
+    }
+    return std::string(reinterpret_cast<const char*>(strings) + ref.offset, ref.length);
+}
+
+void ObservationReader::readAddresses(CDPLayer::Addresses& list) {
+    list.numberOfAddresses = get<uint32_t>();
+    uint32_t count = get<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        CDPLayer::Address address;
+        address.protocolType = get<uint16_t>();
+        address.protocolLength = get<uint16_t>();
+        address.protocol = get<uint16_t>();
+        size_t addressLength;
+        address.address = getBytes(addressLength);
+        address.addressLength = static_cast<uint16_t>(addressLength);
+        list.addresses.push_back(address);
+    }
+}
+
+Observation ObservationReader::getFields(ProtocolType protocol, const timespec& ts) {
+    switch (protocol) {
+        case ProtocolType::DHCP: {
+            pcpp::MacAddress mac = getMac();
+            pcpp::IPAddress ip = getIp();
+            pcpp::IPAddress server = getIp();
+            pcpp::IPAddress gateway = getIp();
+            pcpp::IPAddress dns = getIp();
+            std::string hostname = getString();
+            return DHCPData(ts, mac, ip, hostname, server, gateway, dns);
+        }
+        case ProtocolType::MDNS: {
+            std::string domain = getString();
+            pcpp::MacAddress mac = getMac();
+            std::string hostname = getString();
+            pcpp::IPAddress ip = getIp();
+            return mDNSData(ts, domain, mac, hostname, ip);
+        }
+        case ProtocolType::ARP: {
+            pcpp::MacAddress mac = getMac();
+            pcpp::IPAddress sender = getIp();
+            pcpp::IPAddress target = getIp();
+            return ARPData(ts, mac, sender, target);
+        }
+        case ProtocolType::SSDP: {
+            pcpp::MacAddress mac = getMac();
+            pcpp::IPv4Address ip(get<uint32_t>());
+            auto type = static_cast<SSDPLayer::SSDPType>(get<uint8_t>());
+            uint32_t count = get<uint32_t>();
+            SSDPData::Headers headers;
+            for (uint32_t i = 0; i < count; i++) {
+                InternedString name = getString();
+                headers.emplace_back(std::move(name), getString());
+            }
+            return SSDPData(ts, mac, ip, type, std::move(headers));
+        }
+        case ProtocolType::LLDP: {
+            pcpp::MacAddress mac = getMac();
+            std::string portId = getString();
+            std::string portDescription = getString();
+            std::string systemName = getString();
+            std::string systemDescription = getString();
+            return LLDPData(ts, mac, portId, portDescription, systemName, systemDescription);
+        }
+        case ProtocolType::CDP: {
+            auto cdp = std::make_unique<CDPData>(ts, getMac());
+            cdp->senderIP = pcpp::IPv4Address(get<uint32_t>());
+            cdp->deviceId.subtype = static_cast<CDPLayer::DeviceIdSubtype>(get<uint8_t>());
+            cdp->deviceId.id = getString();
+            readAddresses(cdp->addresses);
+            cdp->portId = getString();
+            cdp->capabilities = get<uint32_t>();
+            cdp->capabilitiesStr = getString();
+            cdp->softwareVersion = getString();
+            cdp->platform = getString();
+            cdp->vtpManagementDomain = getString();
+            cdp->nativeVlan = get<uint16_t>();
+            cdp->duplex = get<uint8_t>();
+            cdp->trustBitmap = get<uint8_t>();
+            cdp->untrustedPortCos = get<uint8_t>();
+            readAddresses(cdp->mgmtAddresses);
+            // The addresses point into the record until copied
+            cdp->ownAddresses();
+            return Observation(std::move(cdp));
+        }
+        case ProtocolType::STP: {
+            pcpp::MacAddress mac = getMac();
+            STPLayer::RootIdentifier root = get<STPLayer::RootIdentifier>();
+            STPLayer::BridgeIdentifier bridge = get<STPLayer::BridgeIdentifier>();
+            return STPData(ts, mac, root, bridge);
+        }
+        case ProtocolType::WOL: {
+            pcpp::MacAddress sender = getMac();
+            pcpp::MacAddress target = getMac();
+            return WOLData(ts, sender, target);
+        }
+    }
+    throw std::out_of_range("unknown protocol");
+}
@@ -0,0 +1,125 @@
+#ifndef OBSERVATION_CODEC_HPP
+#define OBSERVATION_CODEC_HPP
+
+#include "ProtocolData.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Reference to a string or byte list of a StringTable
+struct StringRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+// Word-at-a-time multiply-xorshift hash of a byte range, to detect corrupted records
+uint64_t checksum64(const uint8_t* data, size_t length);
+
+/**
+ * @class StringTable
+ * @brief Concatenation of distinct strings, each stored once and referenced by offset and length.
+ */
+class StringTable {
+  public:
+    StringTable();
+    StringRef intern(const std::string& value);
+    StringRef intern(const uint8_t* data, size_t length);
+    const std::string& data() const { return strings; }
+    // Number of distinct strings
+    size_t size() const { return interned.size(); }
+
+  private:
+    std::string strings;
+    std::unordered_map<std::string, uint32_t> interned;
+};
+
+/**
+ * @class ObservationWriter
+ *
+ * @brief Appends the fields of observations to a binary record, in host byte order.
+ *
+ * Strings and byte lists are written as references to a StringTable when one is given,
+ * otherwise inline, behind their length as a varint, so that a record stands on its own.
+ */
+class ObservationWriter {
+  public:
+    explicit ObservationWriter(std::string& out, StringTable* table = nullptr) : out(out), table(table) {}
+
+    template <typename T>
+    void put(const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    void putMac(const pcpp::MacAddress& mac);
+    // Version byte, 0 when unset, then 16 address bytes
+    void putIp(const pcpp::IPAddress& ip);
+    void putString(const std::string& value);
+    // The text of an interned string, the IDs are not stable across processes
+    void putString(const InternedString& value) { putBytes(reinterpret_cast<const uint8_t*>(value.view().data()), value.view().size()); }
+    void putBytes(const uint8_t* data, size_t length);
+    // The protocol fields of an observation, without its timestamp and ingress
+    void putFields(const Observation& observation);
+    // LEB128, 7 bits per byte
+    void putVarint(uint64_t value);
+
+  private:
+
+    std::string& out;
+    StringTable* table;
+};
+
+/**
+ * @class ObservationReader
+ *
+ * @brief Bounds-checked cursor over a record written by an ObservationWriter.
+ *
+ * A read past the end of the record, or a string reference past the end of the string table,
+ * throws std::out_of_range.
+ */
+class ObservationReader {
+  public:
+    // Record with inline strings
+    ObservationReader(const uint8_t* data, size_t length) : data(data), length(length) {}
+    // Record referencing a string table
+    ObservationReader(const uint8_t* data, size_t length, const uint8_t* strings, size_t stringsLength)
+        : data(data), length(length), strings(strings), stringsLength(stringsLength), tableStrings(true) {}
+
+    template <typename T>
+    T get() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+    pcpp::MacAddress getMac();
+    pcpp::IPAddress getIp();
+    std::string getString();
+    uint64_t getVarint();
+    // Bytes of a byte list, valid as long as the record or the string table
+    const uint8_t* getBytes(size_t& count);
+    // Rebuild an observation of a protocol from its fields
+    Observation getFields(ProtocolType protocol, const timespec& timestamp);
+
+    // String of the string table
+    std::string resolve(const StringRef& ref) const;
+    // Bytes read so far
+    size_t position() const { return offset; }
+
+    static pcpp::IPAddress toIp(uint8_t version, const uint8_t* bytes);
+
+  private:
+    void require(size_t count) const;
+    void readAddresses(CDPLayer::Addresses& list);
+
+    const uint8_t* data;
+    size_t length;
+    size_t offset = 0;
+    const uint8_t* strings = nullptr;
+    size_t stringsLength = 0;
+    bool tableStrings = false;
+};
+
+#endif // OBSERVATION_CODEC_HPP
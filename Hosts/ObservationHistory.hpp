@@ -0,0 +1,133 @@
+#ifndef OBSERVATION_HISTORY_HPP
+#define OBSERVATION_HISTORY_HPP
+
+#include "ProtocolData.hpp"
+#include "Fingerprint.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @class ObservationHistory
+ *
+ * @brief Bounded history of the distinct observations of one protocol for one host.
+ *
+ * The history keeps the most recently seen distinct observations inline, oldest first, the last
+ * one being the latest state of the host for the protocol. Observations are matched by their
+ * fingerprint, computed once when they are recorded, and only compared field by field (see
+ * ProtocolDataComparator) when the fingerprints are equal. An observation equal to a kept one
+ * refreshes it: its last seen timestamp, ingress and lifetime are updated, its hit count
+ * incremented and it becomes the latest. A new distinct observation is appended, and once the
+ * history holds the capacity of its protocol, the least recently seen one is dropped. The memory of a host is thus bounded by the capacities, whatever the traffic.
+ *
+ * Capacities are global and per protocol; they are set at startup, before any host is
+ * updated, and apply to every history of the protocol from its next update.
+ *
+ * The observations are allocated from the memory resource of the host store.
+ */
+class ObservationHistory {
+  public:
+    static constexpr size_t DefaultCapacity = 4;
+
+    using Entries = std::pmr::vector<Observation>;
+
+    explicit ObservationHistory(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : entries(resource) {}
+
+    // Distinct observations kept per host for a protocol, at least 1
+    static void setCapacity(ProtocolType protocol, size_t capacity) {
+        capacities[static_cast<size_t>(protocol)] = capacity > 0 ? capacity : 1;
+    }
+    static size_t getCapacity(ProtocolType protocol) { return capacities[static_cast<size_t>(protocol)]; }
+
+    // Record an observation, returns false if it refreshed a kept one
+    bool record(Observation observation) {
+        size_t i = find(observation);
+        ProtocolData& data = dataOf(observation);
+        if (i != entries.size()) {
+            ProtocolData& kept = dataOf(entries[i]);
+            kept.timestamp = data.timestamp;
+            kept.ingress = std::move(data.ingress);
+            kept.ttl = data.ttl;
+            kept.expiresAt = data.expiresAt;
+            if (kept.hits != UINT32_MAX) {
+                kept.hits++;
+            }
+            // Rotate it to the back, as the latest state
+            std::rotate(entries.begin() + i, entries.begin() + i + 1, entries.end());
+            return false;
+        }
+        if (data.firstSeen.tv_sec == 0 && data.firstSeen.tv_nsec == 0) {
+            data.firstSeen = data.timestamp;
+        }
+        size_t capacity = getCapacity(protocolOf(observation));
+        if (entries.size() >= capacity) {
+            entries.erase(entries.begin(), entries.begin() + (entries.size() - capacity + 1));
+        }
+        entries.push_back(std::move(observation));
+        return true;
+    }
+
+    // Remove a kept observation equal to the given one, false if none
+    bool remove(Observation& observation) {
+        size_t i = find(observation);
+        if (i == entries.size()) {
+            return false;
+        }
+        entries.erase(entries.begin() + i);
+        return true;
+    }
+
+    // Remove the observations a predicate holds for, returns how many
+    template <typename Predicate>
+    size_t removeIf(Predicate&& predicate) {
+        size_t before = entries.size();
+        for (auto it = entries.begin(); it != entries.end();) {
+            it = predicate(dataOf(*it)) ? entries.erase(it) : it + 1;
+        }
+        return before - entries.size();
+    }
+
+    // Call a function with the kept observations, least recently seen first, allowed to change their lifetime fields
+    template <typename Function>
+    void forEach(Function&& function) {
+        for (Observation& observation : entries) {
+            function(observation);
+        }
+    }
+
+    // Most recently seen observation, nullptr if none
+    const Observation* latest() const { return entries.empty() ? nullptr : &entries.back(); }
+    Observation* latest() { return entries.empty() ? nullptr : &entries.back(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Kept observations, least recently seen first
+    Entries::const_iterator begin() const { return entries.begin(); }
+    Entries::const_iterator end() const { return entries.end(); }
+
+  private:
+    // Index of the kept observation equal to the given one, whose fingerprint is computed, size() if none
+    size_t find(Observation& observation) const {
+        ProtocolData& data = dataOf(observation);
+        if (data.fingerprint == 0) {
+            data.fingerprint = fingerprintOf(observation);
+        }
+        ProtocolDataComparator differs;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (dataOf(entries[i]).fingerprint == data.fingerprint && !differs(entries[i], observation)) {
+                return i;
+            }
+        }
+        return entries.size();
+    }
+
+    Entries entries;
+
+    static inline std::array<size_t, 8> capacities = {DefaultCapacity, DefaultCapacity, DefaultCapacity, DefaultCapacity,
+                                                      DefaultCapacity, DefaultCapacity, DefaultCapacity, DefaultCapacity};
+};
+
+#endif // OBSERVATION_HISTORY_HPP
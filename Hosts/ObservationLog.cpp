@@ -0,0 +1,326 @@
+#include "ObservationLog.hpp"
+#include "ObservationCodec.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Start of every segment, the last byte is the format version
+constexpr char Magic[8] = {'N', 'P', 'W', 'A', 'L', '\r', '\n', 2};
+
+struct RecordHeader {
+    // Bytes of the record after the header
+    uint32_t size;
+    // Low 32 bits of the checksum of those bytes
+    uint32_t checksum;
+    uint8_t protocol;
+    uint8_t reserved[3];
+    uint32_t timestampNs;
+    int64_t timestamp;
+};
+
+static_assert(sizeof(RecordHeader) == 24, "padded record header");
+
+constexpr uint8_t ProtocolCount = 8;
+
+bool writeAll(int fd, const char* data, size_t length) {
+    size_t written = 0;
+    while (written < length) {
+        ssize_t count = write(fd, data + written, length - written);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        written += count;
+    }
+    return true;
+}
+
+void syncDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    int directoryFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directoryFd >= 0) {
+        fsync(directoryFd);
+        ::close(directoryFd);
+    }
+}
+
+} // namespace
+
+int ObservationLog::openSegment(const std::string& path, bool truncate) {
+    int segmentFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+    if (segmentFd < 0) {
+        std::cerr << "Error: Unable to open " << path << ": " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    struct stat status{};
+    if (fstat(segmentFd, &status) == 0 && status.st_size == 0 && !writeAll(segmentFd, Magic, sizeof(Magic))) {
+        std::cerr << "Error: Unable to write " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(segmentFd);
+        return -1;
+    }
+    return segmentFd;
+}
+
+bool ObservationLog::open() {
+    if (thread.joinable()) {
+        return true;
+    }
+    fd = openSegment(path, false);
+    if (fd < 0) {
+        return false;
+    }
+    syncDirectory(path);
+    stopping = false;
+    thread = std::thread([this]() { run(); });
+    return true;
+}
+
+void ObservationLog::close() {
+    if (!thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+    ::close(fd);
+    fd = -1;
+}
+
+ObservationLog::Buffer& ObservationLog::addBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.push_back(std::make_unique<Buffer>(*this));
+    return *buffers.back();
+}
+
+void ObservationLog::Buffer::append(const Observation& observation) {
+    // Encoded outside the lock, in a buffer reused by the thread
+    thread_local std::string record;
+    record.clear();
+    ObservationWriter writer(record);
+    const ProtocolData& data = dataOf(observation);
+    RecordHeader header{};
+    header.protocol = static_cast<uint8_t>(protocolOf(observation));
+    header.timestamp = data.timestamp.tv_sec;
+    header.timestampNs = static_cast<uint32_t>(data.timestamp.tv_nsec);
+    writer.put(header);
+    writer.putString(data.ingress);
+    writer.putVarint(data.ttl);
+    writer.putFields(observation);
+
+    header.size = static_cast<uint32_t>(record.size() - sizeof(RecordHeader));
+    header.checksum = static_cast<uint32_t>(
+        checksum64(reinterpret_cast<const uint8_t*>(record.data()) + sizeof(RecordHeader), header.size));
+    std::memcpy(&record[0], &header, sizeof(header));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.size() + record.size() > log.maxPending) {
+        dropped++;
+        return;
+    }
+    pending += record;
+    records++;
+    if (pending.size() >= BatchBytes && !log.batchReady.exchange(true, std::memory_order_relaxed)) {
+        log.wake.notify_one();
+    }
+}
+
+void ObservationLog::gather() {
+    for (auto& buffer : buffers) {
+        // Cleared rather than swapped, the buffer keeps its capacity for the next records
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        writing += buffer->pending;
+        buffer->pending.clear();
+    }
+}
+
+void ObservationLog::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait_for(lock, commitInterval, [this]() {
+            return stopping || rotateRequested || batchReady.load(std::memory_order_relaxed);
+        });
+        bool stop = stopping;
+        bool rotating = rotateRequested;
+        batchReady.store(false, std::memory_order_relaxed);
+        gather();
+        lock.unlock();
+
+        // The records gathered by a rotation go to the previous segment, the next ones to a new one
+        commit(writing.data(), writing.size());
+        bool rotateOk = rotating && rotateFiles();
+        writing.clear();
+
+        lock.lock();
+        if (rotating) {
+            rotateRequested = false;
+            rotateSucceeded = rotateOk;
+            rotated.notify_all();
+        }
+        if (stop) {
+            return;
+        }
+    }
+}
+
+void ObservationLog::commit(const char* data, size_t length) {
+    if (length == 0 || fd < 0) {
+        return;
+    }
+    if (!writeAll(fd, data, length) || fdatasync(fd) != 0) {
+        std::cerr << "Error: Unable to write " << path << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    commits.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(length, std::memory_order_relaxed);
+}
+
+bool ObservationLog::rotateFiles() {
+    std::string previous = path + ".prev";
+    if (access(previous.c_str(), F_OK) == 0) {
+        // The last snapshot failed, its segment still needed: append this segment to it
+        int previousFd = openSegment(previous, false);
+        int currentFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        bool copied = previousFd >= 0 && currentFd >= 0 && lseek(currentFd, sizeof(Magic), SEEK_SET) >= 0;
+        char buffer[1 << 16];
+        ssize_t count;
+        while (copied && (count = read(currentFd, buffer, sizeof(buffer))) != 0) {
+            copied = count > 0 ? writeAll(previousFd, buffer, count) : errno == EINTR;
+        }
+        copied = copied && fdatasync(previousFd) == 0;
+        if (previousFd >= 0) ::close(previousFd);
+        if (currentFd >= 0) ::close(currentFd);
+        if (!copied) {
+            std::cerr << "Error: Unable to rotate " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+    } else if (rename(path.c_str(), previous.c_str()) != 0) {
+        std::cerr << "Error: Unable to rotate " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    ::close(fd);
+    fd = openSegment(path, true);
+    syncDirectory(path);
+    return fd >= 0;
+}
+
+bool ObservationLog::rotate() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!thread.joinable() || stopping) {
+        return false;
+    }
+    rotateRequested = true;
+    wake.notify_one();
+    rotated.wait(lock, [this]() { return !rotateRequested; });
+    return rotateSucceeded;
+}
+
+void ObservationLog::dropRotated() {
+    unlink((path + ".prev").c_str());
+    syncDirectory(path);
+}
+
+ObservationLog::Stats ObservationLog::getStats() const {
+    Stats stats;
+    stats.bytes = bytes.load(std::memory_order_relaxed);
+    stats.commits = commits.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        stats.records += buffer->records;
+        stats.dropped += buffer->dropped;
+    }
+    return stats;
+}
+
+ObservationLog::ReplayResult ObservationLog::replay(const std::string& path,
+                                                    const std::function<void(Observation)>& onObservation) {
+    auto start = std::chrono::steady_clock::now();
+    ReplayResult result;
+    readSegment(path + ".prev", onObservation, result);
+    readSegment(path, onObservation, result);
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+void ObservationLog::readSegment(const std::string& path,
+                                 const std::function<void(Observation)>& onObservation,
+                                 ReplayResult& result) {
+    int segmentFd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (segmentFd < 0) {
+        if (errno != ENOENT) {
+            std::cerr << "Error: Unable to open " << path << ": " << std::strerror(errno) << std::endl;
+        }
+        return;
+    }
+    struct stat status{};
+    if (fstat(segmentFd, &status) != 0 || status.st_size == 0) {
+        ::close(segmentFd);
+        return;
+    }
+    size_t length = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, segmentFd, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error: Unable to map " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(segmentFd);
+        return;
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    const uint8_t* data = static_cast<const uint8_t*>(mapping);
+
+    size_t offset = 0;
+    if (length >= sizeof(Magic) && std::memcmp(data, Magic, sizeof(Magic)) == 0) {
+        offset = sizeof(Magic);
+        while (length - offset >= sizeof(RecordHeader)) {
+            RecordHeader header;
+            std::memcpy(&header, data + offset, sizeof(header));
+            const uint8_t* payload = data + offset + sizeof(RecordHeader);
+            if (header.size > length - offset - sizeof(RecordHeader) || header.protocol >= ProtocolCount ||
+                static_cast<uint32_t>(checksum64(payload, header.size)) != header.checksum) {
+                break;
+            }
+            try {
+                ObservationReader reader(payload, header.size);
+                std::string ingress = reader.getString();
+                uint64_t ttl = reader.getVarint();
+                Observation observation = reader.getFields(
+                    static_cast<ProtocolType>(header.protocol), {header.timestamp, header.timestampNs});
+                ProtocolData& data = dataOf(observation);
+                data.ingress = InternedString(ingress);
+                data.ttl = static_cast<uint32_t>(ttl);
+                onObservation(std::move(observation));
+            } catch (const std::out_of_range&) {
+                break;
+            }
+            offset += sizeof(RecordHeader) + header.size;
+            result.observations++;
+        }
+    } else {
+        std::cerr << "Warning: " << path << " is not an observation log, ignored" << std::endl;
+    }
+    munmap(mapping, length);
+    result.bytes += offset;
+
+    // Cut the torn tail, so that the records appended next are not hidden behind it
+    if (offset > 0 && offset < length) {
+        result.discarded += length - offset;
+        std::cerr << "Warning: " << path << ": " << length - offset << " bytes of torn records cut" << std::endl;
+        if (ftruncate(segmentFd, offset) != 0) {
+            std::cerr << "Error: Unable to truncate " << path << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+    ::close(segmentFd);
+}
@@ -0,0 +1,145 @@
+#ifndef OBSERVATION_LOG_HPP
+#define OBSERVATION_LOG_HPP
+
+#include "ProtocolData.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ObservationLog
+ *
+ * @brief Write-ahead log of the observations accepted since the last host snapshot.
+ *
+ * Every observation handed to the HostManagers is encoded into a binary record (length,
+ * checksum, protocol, timestamp, ingress, TTL and the protocol fields, strings inline) and queued
+ * in memory, in a Buffer of the HostManager shard that accepted it: the shards never share a
+ * lock nor a counter to log. A commit thread gathers the buffers, writes the records in one
+ * batch and flushes them with fdatasync every commit interval, or as soon as a buffer holds a
+ * full batch: the analysis never waits on the disk, and a crash loses at most the last commit
+ * interval. Records are dropped and counted rather than blocking the analysis when the disk
+ * falls too far behind. The records of a host are logged in order by its shard; the records
+ * of different shards are interleaved in the log.
+ *
+ * The log follows the snapshots: before a snapshot is taken, rotate() moves the records
+ * gathered so far, at least those logged before the call, to a previous segment (<path>.prev), which dropRotated() deletes once the
+ * snapshot is durable. On startup, replay() hands the records of both segments to the host
+ * store loaded from the snapshot; a record replayed twice only refreshes its observation.
+ * A torn or corrupted record ends its segment, which is truncated there.
+ */
+class ObservationLog {
+  public:
+    struct Stats {
+        uint64_t records = 0;
+        uint64_t bytes = 0;
+        uint64_t commits = 0;
+        uint64_t dropped = 0;
+    };
+
+    struct ReplayResult {
+        size_t observations = 0;
+        size_t bytes = 0;
+        // Bytes of torn or corrupted records cut from the end of the segments
+        size_t discarded = 0;
+        std::chrono::microseconds elapsed{0};
+    };
+
+    explicit ObservationLog(std::string path, std::chrono::milliseconds commitInterval = std::chrono::milliseconds(10),
+                            size_t maxPending = 64 << 20)
+        : path(std::move(path)), commitInterval(commitInterval), maxPending(maxPending) {}
+    ~ObservationLog() { close(); }
+
+    ObservationLog(const ObservationLog&) = delete;
+    ObservationLog& operator=(const ObservationLog&) = delete;
+
+    /**
+     * @class Buffer
+     *
+     * @brief Records queued by one writer, a HostManager shard, until the commit thread gathers them.
+     */
+    class Buffer {
+      public:
+        explicit Buffer(ObservationLog& log) : log(log) {}
+        // Queue an observation, without waiting on the disk
+        void append(const Observation& observation);
+
+      private:
+        friend class ObservationLog;
+        ObservationLog& log;
+        // Guards the records and counters below, shared with the commit thread only
+        std::mutex mutex;
+        std::string pending;
+        uint64_t records = 0;
+        uint64_t dropped = 0;
+    };
+
+    // Open the log for appending and start the commit thread, after replay()
+    bool open();
+    // Commit the queued records and stop the commit thread
+    void close();
+    // Any thread: a new buffer to queue observations in, owned by the log; one per writer
+    Buffer& addBuffer();
+    // Commit the queued records to a previous segment and log the next ones to a new one
+    bool rotate();
+    // Delete the previous segment, its observations being in a durable snapshot
+    void dropRotated();
+    Stats getStats() const;
+    const std::string& getPath() const { return path; }
+
+    /**
+     * @brief Reads the observations of the previous segment then of the current one.
+     *
+     * @param path The log file.
+     * @param onObservation Called with every observation, in the order they were logged.
+     * @return The number of observations and bytes read, and the bytes cut from torn segments.
+     */
+    static ReplayResult replay(const std::string& path,
+                               const std::function<void(Observation)>& onObservation);
+
+  private:
+    // Commit thread: wait for a batch, write it and flush it, rotating the segments on request
+    void run();
+    // Move the records of every buffer to the batch being committed, with mutex held
+    void gather();
+    void commit(const char* data, size_t length);
+    bool rotateFiles();
+    static int openSegment(const std::string& path, bool truncate);
+    static void readSegment(const std::string& path,
+                            const std::function<void(Observation)>& onObservation,
+                            ReplayResult& result);
+
+    std::string path;
+    std::chrono::milliseconds commitInterval;
+    // Bytes a buffer queues before dropping records
+    size_t maxPending;
+    // Records are committed early once this many bytes are queued
+    static constexpr size_t BatchBytes = 1 << 20;
+
+    // Guards the list of buffers and the requests to the commit thread
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable rotated;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    bool stopping = false;
+    bool rotateRequested = false;
+    bool rotateSucceeded = false;
+    // Set by a buffer holding a full batch; the commit thread may miss it for one interval
+    std::atomic<bool> batchReady{false};
+
+    // Batch being committed, and the current segment, only used by the commit thread
+    std::string writing;
+    int fd = -1;
+    std::thread thread;
+
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> commits{0};
+};
+
+#endif // OBSERVATION_LOG_HPP
@@ -3,12 +3,20 @@
 
 #include "MacAddress.h"
 #include "IPv4Layer.h"
+#include "StringInterner.hpp"
 #include "../Layers/STP/STPLayer.hpp"
+#include "../Layers/LLDP/LLDPLayer.hpp"
 #include "../Layers/SSDP/SSDPLayer.hpp"
 #include "../Layers/CDP/CDPLayer.hpp"
 #include <string>
 #include <ctime>
 #include <unordered_set>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 enum class ProtocolType {
     DHCP,
@@ -35,19 +43,31 @@ struct PairHash {
  * @brief Base class for protocol-specific data.
  * 
  * The ProtocolData class is a base class for protocol-specific data structures.
- * It provides a common interface for accessing protocol data and a virtual
- * method to retrieve the protocol type.
+ * It holds the fields common to every protocol; it is not polymorphic, the
+ * observations are handled by value as an Observation, see below.
  * 
- * Derived classes must implement the getProtocolType method to return the
- * specific protocol type.
+ * The ingress interface is not part of the identity of
+ * an observation: the same data seen on two interfaces is stored once, nor are
+ * its lifetime fields, refreshed with the timestamp. The timestamp is the last
+ * time the observation was seen, firstSeen and hits are kept by its history.
  */
 struct ProtocolData {
     ProtocolType protocol;
     timespec timestamp;
+    // First time the observation was seen, and the number of times it was
+    timespec firstSeen{};
+    uint32_t hits = 1;
+    // Interface the observation was captured on, stamped by the HostManager; interned like the host interfaces
+    InternedString ingress;
+    // Lifetime announced by the protocol in seconds, 0 when it announces none
+    uint32_t ttl = 0;
+    // Realtime second the observation expires at, set by the HostManager, 0 for never
+    int64_t expiresAt = 0;
+    // Content hash, see fingerprintOf(), 0 until computed by the history recording the observation
+    uint64_t fingerprint = 0;
      ProtocolData(ProtocolType proto, timespec ts = {}) 
         : protocol(proto), timestamp(ts) {}
-    virtual ~ProtocolData() = default;
-    virtual ProtocolType getProtocolType() const {
+    ProtocolType getProtocolType() const {
         return protocol;
     }
 };
@@ -121,7 +141,8 @@ struct ARPData : public ProtocolData {
  * 
  * The LLDPData struct is a data structure for storing LLDP protocol data.
  * It contains fields for the sender MAC address, port ID, port description,
- * system name, and system description.
+ * system name, and system description. The system description, repeated by every device
+ * of a model, is interned.
  */
 
 struct LLDPData : public ProtocolData {
@@ -129,10 +150,16 @@ struct LLDPData : public ProtocolData {
     std::string portID;
     std::string portDescription;
     std::string systemName;
-    std::string systemDescription;
+    InternedString systemDescription;
 
-    LLDPData(timespec ts, pcpp::MacAddress mac, std::string port, std::string portDesc, std::string sysName, std::string sysDesc)
-        : ProtocolData(ProtocolType::LLDP, ts), senderMAC(mac), portID(port), portDescription(portDesc), systemName(sysName), systemDescription(sysDesc) {}
+    LLDPData(timespec ts, pcpp::MacAddress mac, std::string port, std::string portDesc, std::string sysName, InternedString sysDesc)
+        : ProtocolData(ProtocolType::LLDP, ts), senderMAC(mac), portID(std::move(port)), portDescription(std::move(portDesc)), systemName(std::move(sysName)), systemDescription(std::move(sysDesc)) {}
+
+    // Whether a frame carries this observation again, compared in place without building one
+    bool repeatedBy(const LLDPLayer& layer) const {
+        return layer.portIdEquals(portID) && layer.getPortDescriptionView() == portDescription &&
+               layer.getSystemNameView() == systemName && layer.getSystemDescriptionView() == systemDescription.view();
+    }
 };
 
 // Data structure for STP protocol
@@ -163,17 +190,33 @@ struct STPData : public ProtocolData {
  * 
  * The SSDPData struct is a data structure for storing SSDP protocol data.
  * It contains fields for the sender MAC address, sender IP address, SSDP type,
- * and SSDP headers.
+ * and SSDP headers. The header names and values are interned.
  */
 struct SSDPData : public ProtocolData {
+    using Headers = std::vector<std::pair<InternedString, InternedString>>;
+
     pcpp::MacAddress senderMAC;
     pcpp::IPv4Address senderIP;
 
     SSDPLayer::SSDPType ssdpType;
-    std::vector<std::pair<std::string, std::string>> ssdpHeaders;
+    Headers ssdpHeaders;
+
+    SSDPData(timespec ts, pcpp::MacAddress mac, pcpp::IPv4Address ip, SSDPLayer::SSDPType type, Headers headers)
+        : ProtocolData(ProtocolType::SSDP, ts), senderMAC(mac), senderIP(ip), ssdpType(type), ssdpHeaders(std::move(headers)) {}
 
-    SSDPData(timespec ts, pcpp::MacAddress mac, pcpp::IPv4Address ip, SSDPLayer::SSDPType type, std::vector<std::pair<std::string, std::string>> headers)
-        : ProtocolData(ProtocolType::SSDP, ts), senderMAC(mac), senderIP(ip), ssdpType(type), ssdpHeaders(headers) {}
+    // Whether a frame sent from an address carries this observation again, the same headers in the same order
+    bool repeatedBy(const SSDPLayer& layer, pcpp::IPv4Address ip) const {
+        const auto& headers = layer.getSSDPHeaders();
+        if (ip != senderIP || headers.size() != ssdpHeaders.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < headers.size(); i++) {
+            if (ssdpHeaders[i].first.view() != headers[i].first || ssdpHeaders[i].second.view() != headers[i].second) {
+                return false;
+            }
+        }
+        return true;
+    }
 };
 
 // Data structure for CDP protocol
@@ -184,7 +227,9 @@ struct SSDPData : public ProtocolData {
  * The CDPData struct is a data structure for storing CDP protocol data.
  * It contains fields for the sender MAC address, sender IP address, device ID,
  * addresses, port ID, capabilities, software version, platform, VTP management domain,
- * native VLAN, duplex, trust bitmap, untrusted port CoS, and management addresses.
+ * native VLAN, duplex, trust bitmap, untrusted port CoS, and management addresses. The
+ * capabilities, software version and platform strings, shared by every device of a model,
+ * are interned.
  */
 struct CDPData : public ProtocolData {
     pcpp::MacAddress senderMAC;
@@ -193,18 +238,76 @@ struct CDPData : public ProtocolData {
     CDPLayer::Addresses addresses;
     std::string portId;
     uint32_t capabilities;
-    std::string capabilitiesStr;
-    std::string softwareVersion;
-    std::string platform;
+    InternedString capabilitiesStr;
+    InternedString softwareVersion;
+    InternedString platform;
     std::string vtpManagementDomain;
     uint16_t nativeVlan;
     uint8_t duplex;
     uint8_t trustBitmap;
     uint8_t untrustedPortCos;
     CDPLayer::Addresses mgmtAddresses;
+    // Copy of the address bytes, the parsed addresses point into the packet buffer
+    std::vector<std::vector<uint8_t>> addressStorage;
+
+    CDPData(timespec ts, pcpp::MacAddress mac, const CDPLayer& cdpLayer)
+        : ProtocolData(ProtocolType::CDP, ts), senderMAC(mac), deviceId(cdpLayer.getDeviceId()), addresses(cdpLayer.getAddresses()), portId(cdpLayer.getPortId()), capabilities(cdpLayer.getCapabilities()), capabilitiesStr(cdpLayer.capabilitiesToString(cdpLayer.getCapabilities())), softwareVersion(cdpLayer.getSoftwareVersion()), platform(cdpLayer.getPlatform()), vtpManagementDomain(cdpLayer.getVTPManagementDomain()), nativeVlan(cdpLayer.getNativeVlan()), duplex(cdpLayer.getDuplex()), trustBitmap(cdpLayer.getTrustBitmap()), untrustedPortCos(cdpLayer.getUntrustedPortCos()), mgmtAddresses(cdpLayer.getMgmtAddresses()) {
+        ownAddresses();
+    }
+
+    // Empty observation, filled field by field when a snapshot is loaded
+    CDPData(timespec ts, pcpp::MacAddress mac)
+        : ProtocolData(ProtocolType::CDP, ts), senderMAC(mac), deviceId{CDPLayer::DEVICE_ID_SUBTYPE_LOCAL, ""}, addresses{{}, 0},
+          capabilities(0), nativeVlan(0), duplex(0), trustBitmap(0), untrustedPortCos(0), mgmtAddresses{{}, 0} {}
+
+    CDPData(const CDPData&) = delete;
+    CDPData& operator=(const CDPData&) = delete;
+
+    // Whether a frame carries this observation again, compared in place without building one
+    bool repeatedBy(const CDPLayer& layer) const {
+        return layer.deviceIdEquals(deviceId.subtype, deviceId.id) && layer.getPortIdView() == portId &&
+               layer.getCapabilities() == capabilities && layer.softwareVersionEquals(softwareVersion.view()) &&
+               layer.platformEquals(platform.view()) && layer.getVTPManagementDomainView() == vtpManagementDomain &&
+               layer.getNativeVlan() == nativeVlan && layer.getDuplex() == duplex && layer.getTrustBitmap() == trustBitmap &&
+               layer.getUntrustedPortCos() == untrustedPortCos &&
+               sameAddresses(addresses, layer, CDPLayer::CDP_TLV_TYPE_ADDRESS) &&
+               sameAddresses(mgmtAddresses, layer, CDPLayer::CDP_TLV_TYPE_MGMT_ADDRESS);
+    }
+
+    // Whether the addresses of a TLV of a frame are the kept ones, truncated as ownAddresses() keeps them
+    static bool sameAddresses(const CDPLayer::Addresses& kept, const CDPLayer& layer, CDPLayer::CDPTlvType type) {
+        size_t index = 0;
+        bool same = true;
+        layer.forEachAddress(type, [&](CDPLayer::Address address) {
+            address.addressLength = std::min<uint16_t>(address.addressLength, 16);
+            same = same && index < kept.addresses.size() && kept.addresses[index] == address;
+            index++;
+        });
+        return same && index == kept.addresses.size();
+    }
 
-    CDPData(timespec ts, pcpp::MacAddress mac, CDPLayer cdpLayer)
-        : ProtocolData(ProtocolType::CDP, ts), senderMAC(mac), deviceId(cdpLayer.getDeviceId()), addresses(cdpLayer.getAddresses()), portId(cdpLayer.getPortId()), capabilities(cdpLayer.getCapabilities()), capabilitiesStr(cdpLayer.capabilitiesToString(cdpLayer.getCapabilities())), softwareVersion(cdpLayer.getSoftwareVersion()), platform(cdpLayer.getPlatform()), vtpManagementDomain(cdpLayer.getVTPManagementDomain()), nativeVlan(cdpLayer.getNativeVlan()), duplex(cdpLayer.getDuplex()), trustBitmap(cdpLayer.getTrustBitmap()), untrustedPortCos(cdpLayer.getUntrustedPortCos()), mgmtAddresses(cdpLayer.getMgmtAddresses()) {}
+    // Copy the address bytes into the observation, at most 16 of them, and point the addresses at the copy
+    void ownAddresses() {
+        addressStorage.clear();
+        for (CDPLayer::Addresses* list : {&addresses, &mgmtAddresses}) {
+            for (CDPLayer::Address& address : list->addresses) {
+                address.addressLength = std::min<uint16_t>(address.addressLength, 16);
+                // IPv4 addresses are printed from 4 bytes whatever their length
+                std::vector<uint8_t> bytes(std::max<uint16_t>(address.addressLength, 4), 0);
+                if (address.address != nullptr) {
+                    std::copy(address.address, address.address + address.addressLength, bytes.begin());
+                }
+                addressStorage.push_back(std::move(bytes));
+            }
+        }
+        // Point once every copy is in place, the storage does not move anymore
+        size_t index = 0;
+        for (CDPLayer::Addresses* list : {&addresses, &mgmtAddresses}) {
+            for (CDPLayer::Address& address : list->addresses) {
+                address.address = addressStorage[index++].data();
+            }
+        }
+    }
 };
 
 // Data structure for WOL protocol
@@ -223,102 +326,162 @@ struct WOLData : public ProtocolData {
         : ProtocolData(ProtocolType::WOL, ts), senderMAC(sender), targetMAC(target) {}
 };
 
+/**
+ * @brief An observation of any protocol, by value.
+ *
+ * The alternatives are in the order of ProtocolType, so that the index of an observation is its
+ * protocol. Observations are moved from the analyzers to the host records that keep them inline.
+ * CDP advertisements are the exception, held through a pointer: they are rare and take about twice
+ * the size of the other observations, which would otherwise all be as large.
+ *
+ * Observations are visited with visitObservation(), which hands the protocol struct to the visitor
+ * whatever the way it is held; a visitor built with Overloaded and missing a protocol does not
+ * compile.
+ */
+using Observation = std::variant<DHCPData, mDNSData, ARPData, SSDPData, LLDPData, std::unique_ptr<CDPData>, STPData, WOLData>;
+
+static_assert(std::variant_size_v<Observation> == 8, "one alternative per protocol");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::DHCP), Observation>, DHCPData>, "alternative out of order");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::MDNS), Observation>, mDNSData>, "alternative out of order");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::ARP), Observation>, ARPData>, "alternative out of order");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::SSDP), Observation>, SSDPData>, "alternative out of order");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::LLDP), Observation>, LLDPData>, "alternative out of order");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::CDP), Observation>, std::unique_ptr<CDPData>>, "alternative out of order");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::STP), Observation>, STPData>, "alternative out of order");
+static_assert(std::is_same_v<std::variant_alternative_t<size_t(ProtocolType::WOL), Observation>, WOLData>, "alternative out of order");
+
+// Visitor made of one lambda per protocol
+template <typename... Lambdas>
+struct Overloaded : Lambdas... {
+    using Lambdas::operator()...;
+};
+template <typename... Lambdas>
+Overloaded(Lambdas...) -> Overloaded<Lambdas...>;
+
+// The protocol struct of an alternative, held inline or through a pointer
+template <typename T>
+T& unbox(T& data) { return data; }
+template <typename T>
+T& unbox(std::unique_ptr<T>& data) { return *data; }
+template <typename T>
+const T& unbox(const std::unique_ptr<T>& data) { return *data; }
+
+// The protocol of a protocol struct, the index of its alternative
+template <typename Data, size_t Index = 0>
+constexpr ProtocolType protocolOfData() {
+    using Alternative = std::variant_alternative_t<Index, Observation>;
+    if constexpr (std::is_same_v<Alternative, Data> || std::is_same_v<Alternative, std::unique_ptr<Data>>) {
+        return static_cast<ProtocolType>(Index);
+    } else {
+        return protocolOfData<Data, Index + 1>();
+    }
+}
+
+// Call a visitor with the protocol struct of an observation
+template <typename Visitor, typename Variant>
+decltype(auto) visitObservation(Visitor&& visitor, Variant&& observation) {
+    return std::visit([&visitor](auto& data) -> decltype(auto) { return visitor(unbox(data)); }, observation);
+}
+
+inline ProtocolType protocolOf(const Observation& observation) {
+    return static_cast<ProtocolType>(observation.index());
+}
+
+// The fields common to every protocol
+inline ProtocolData& dataOf(Observation& observation) {
+    return visitObservation([](ProtocolData& data) -> ProtocolData& { return data; }, observation);
+}
+inline const ProtocolData& dataOf(const Observation& observation) {
+    return visitObservation([](const ProtocolData& data) -> const ProtocolData& { return data; }, observation);
+}
+
 /**
  * @struct ProtocolDataComparator
  * @brief Comparator for protocol data.
  * 
  * The ProtocolDataComparator struct provides a comparison function for protocol data.
- * It compares two unique pointers to ProtocolData objects based on the protocol type
- * and specific protocol data fields.
+ * It compares two observations based on the protocol type and specific protocol data fields.
  * 
- * This comparator is used to compare protocol data objects in a set to ensure uniqueness.
- * It is used in the HostManager class to maintain a set of unique protocol data objects.
+ * It returns true when the observations differ, ignoring the timestamps, and is used by
+ * ObservationHistory to find the kept observation equal to a new one.
  * 
  */
 struct ProtocolDataComparator {
-    bool operator()(const std::unique_ptr<ProtocolData>& lhs, const std::unique_ptr<ProtocolData>& rhs) const {
-        if (!lhs || !rhs) return false;
+    bool operator()(const Observation& lhs, const Observation& rhs) const {
+        // Compare by protocol type first, then by specific protocol data fields, ignoring timestamp
+        return std::visit([this](const auto& lhsData, const auto& rhsData) {
+            if constexpr (std::is_same_v<decltype(lhsData), decltype(rhsData)>) {
+                return (*this)(unbox(lhsData), unbox(rhsData));
+            } else {
+                return true;
+            }
+        }, lhs, rhs);
+    }
 
-        // Compare by protocol type first
-        if (lhs->getProtocolType() != rhs->getProtocolType()) {
-            return lhs->getProtocolType() < rhs->getProtocolType();
-        }
+    bool operator()(const DHCPData& lhsData, const DHCPData& rhsData) const {
+        return lhsData.clientMac != rhsData.clientMac || lhsData.ipAddress != rhsData.ipAddress || lhsData.hostname != rhsData.hostname ||
+               lhsData.dhcpServerIp != rhsData.dhcpServerIp || lhsData.gatewayIp != rhsData.gatewayIp || lhsData.dnsServerIp != rhsData.dnsServerIp;
+    }
 
-        // Cast and compare by specific protocol data fields, ignoring timestamp
-        if (lhs->getProtocolType() == ProtocolType::DHCP) {
-            const DHCPData* lhsData = static_cast<const DHCPData*>(lhs.get());
-            const DHCPData* rhsData = static_cast<const DHCPData*>(rhs.get());
-            return lhsData->clientMac != rhsData->clientMac || lhsData->ipAddress != rhsData->ipAddress || lhsData->hostname != rhsData->hostname ||
-                   lhsData->dhcpServerIp != rhsData->dhcpServerIp || lhsData->gatewayIp != rhsData->gatewayIp || lhsData->dnsServerIp != rhsData->dnsServerIp;
-        }
+    bool operator()(const mDNSData& lhsData, const mDNSData& rhsData) const {
+        return lhsData.queriedDomain != rhsData.queriedDomain || lhsData.clientMac != rhsData.clientMac || lhsData.hostname != rhsData.hostname || lhsData.ipAddress != rhsData.ipAddress;
+    }
 
-        if (lhs->getProtocolType() == ProtocolType::MDNS) {
-            const mDNSData* lhsData = static_cast<const mDNSData*>(lhs.get());
-            const mDNSData* rhsData = static_cast<const mDNSData*>(rhs.get());
-            return lhsData->queriedDomain != rhsData->queriedDomain || lhsData->clientMac != rhsData->clientMac || lhsData->hostname != rhsData->hostname || lhsData->ipAddress != rhsData->ipAddress;
-        }
+    bool operator()(const ARPData& lhsData, const ARPData& rhsData) const {
+        return lhsData.senderMac != rhsData.senderMac || lhsData.senderIp != rhsData.senderIp || lhsData.targetIp != rhsData.targetIp;
+    }
 
-        if (lhs->getProtocolType() == ProtocolType::ARP) {
-            const ARPData* lhsData = static_cast<const ARPData*>(lhs.get());
-            const ARPData* rhsData = static_cast<const ARPData*>(rhs.get());
-            return lhsData->senderMac != rhsData->senderMac || lhsData->senderIp != rhsData->senderIp || lhsData->targetIp != rhsData->targetIp;
+    bool operator()(const STPData& lhsData, const STPData& rhsData) const {
+        return lhsData.senderMAC != rhsData.senderMAC || lhsData.rootIdentifier.priority != rhsData.rootIdentifier.priority ||
+               lhsData.rootIdentifier.systemIDExtension != rhsData.rootIdentifier.systemIDExtension || lhsData.rootIdentifier.systemID != rhsData.rootIdentifier.systemID ||
+               lhsData.bridgeIdentifier.priority != rhsData.bridgeIdentifier.priority || lhsData.bridgeIdentifier.systemIDExtension != rhsData.bridgeIdentifier.systemIDExtension ||
+               lhsData.bridgeIdentifier.systemID != rhsData.bridgeIdentifier.systemID;
+    }
+
+    bool operator()(const SSDPData& lhsData, const SSDPData& rhsData) const {
+        // Compare sender MAC and IP
+        if (lhsData.senderMAC != rhsData.senderMAC || lhsData.senderIP != rhsData.senderIP) {
+            return true;
         }
 
-        if (lhs->getProtocolType() == ProtocolType::STP) {
-            const STPData* lhsData = static_cast<const STPData*>(lhs.get());
-            const STPData* rhsData = static_cast<const STPData*>(rhs.get());
-            return lhsData->senderMAC != rhsData->senderMAC || lhsData->rootIdentifier.priority != rhsData->rootIdentifier.priority ||
-                   lhsData->rootIdentifier.systemIDExtension != rhsData->rootIdentifier.systemIDExtension || lhsData->rootIdentifier.systemID != rhsData->rootIdentifier.systemID ||
-                   lhsData->bridgeIdentifier.priority != rhsData->bridgeIdentifier.priority || lhsData->bridgeIdentifier.systemIDExtension != rhsData->bridgeIdentifier.systemIDExtension ||
-                   lhsData->bridgeIdentifier.systemID != rhsData->bridgeIdentifier.systemID;
+        // Same headers in the same order, the usual case of a device repeating itself
+        if (lhsData.ssdpHeaders.size() != rhsData.ssdpHeaders.size()) {
+            return true;
+        }
+        if (lhsData.ssdpHeaders == rhsData.ssdpHeaders) {
+            return false;
         }
 
-        if (lhs->getProtocolType() == ProtocolType::SSDP) {
-    const SSDPData* lhsData = static_cast<const SSDPData*>(lhs.get());
-    const SSDPData* rhsData = static_cast<const SSDPData*>(rhs.get());
+        // Compare ssdpHeaders as unordered sets, of the IDs of the interned names and values
+        std::unordered_multiset<std::pair<uint32_t, uint32_t>, PairHash> lhsHeaders;
+        std::unordered_multiset<std::pair<uint32_t, uint32_t>, PairHash> rhsHeaders;
+        for (const auto& header : lhsData.ssdpHeaders) {
+            lhsHeaders.emplace(header.first.getId(), header.second.getId());
+        }
+        for (const auto& header : rhsData.ssdpHeaders) {
+            rhsHeaders.emplace(header.first.getId(), header.second.getId());
+        }
 
-    // Compare sender MAC and IP
-    if (lhsData->senderMAC != rhsData->senderMAC || lhsData->senderIP != rhsData->senderIP) {
-        return true;
+        return lhsHeaders != rhsHeaders;
     }
 
-    // Compare ssdpHeaders as unordered sets
-    std::unordered_multiset<std::pair<std::string, std::string>, PairHash> lhsHeaders(lhsData->ssdpHeaders.begin(), lhsData->ssdpHeaders.end());
-    std::unordered_multiset<std::pair<std::string, std::string>, PairHash> rhsHeaders(rhsData->ssdpHeaders.begin(), rhsData->ssdpHeaders.end());
-
-    if (lhsHeaders != rhsHeaders) {
-        return true;
+    bool operator()(const CDPData& lhsData, const CDPData& rhsData) const {
+        // compare all addresses in the vector using the operator== defined above
+        return lhsData.senderMAC != rhsData.senderMAC || lhsData.deviceId.subtype != rhsData.deviceId.subtype || lhsData.deviceId.id != rhsData.deviceId.id ||
+               lhsData.addresses.addresses.size() != rhsData.addresses.addresses.size() || !std::equal(lhsData.addresses.addresses.begin(), lhsData.addresses.addresses.end(), rhsData.addresses.addresses.begin()) ||
+                 lhsData.portId != rhsData.portId || lhsData.capabilities != rhsData.capabilities || lhsData.capabilitiesStr != rhsData.capabilitiesStr ||
+                    lhsData.softwareVersion != rhsData.softwareVersion || lhsData.platform != rhsData.platform || lhsData.vtpManagementDomain != rhsData.vtpManagementDomain ||
+                    lhsData.nativeVlan != rhsData.nativeVlan || lhsData.duplex != rhsData.duplex || lhsData.trustBitmap != rhsData.trustBitmap || lhsData.untrustedPortCos != rhsData.untrustedPortCos ||
+                    lhsData.mgmtAddresses.addresses.size() != rhsData.mgmtAddresses.addresses.size() || !std::equal(lhsData.mgmtAddresses.addresses.begin(), lhsData.mgmtAddresses.addresses.end(), rhsData.mgmtAddresses.addresses.begin());
     }
 
-    return false;
-}
-
-        if (lhs->getProtocolType() == ProtocolType::CDP) {
-            const CDPData* lhsData = static_cast<const CDPData*>(lhs.get());
-            const CDPData* rhsData = static_cast<const CDPData*>(rhs.get());
-            // compare all addresses in the vector using the operator== defined above
-            return lhsData->senderMAC != rhsData->senderMAC || lhsData->deviceId.subtype != rhsData->deviceId.subtype || lhsData->deviceId.id != rhsData->deviceId.id ||
-                   lhsData->addresses.addresses.size() != rhsData->addresses.addresses.size() || !std::equal(lhsData->addresses.addresses.begin(), lhsData->addresses.addresses.end(), rhsData->addresses.addresses.begin()) ||
-                     lhsData->portId != rhsData->portId || lhsData->capabilities != rhsData->capabilities || lhsData->capabilitiesStr != rhsData->capabilitiesStr ||
-                        lhsData->softwareVersion != rhsData->softwareVersion || lhsData->platform != rhsData->platform || lhsData->vtpManagementDomain != rhsData->vtpManagementDomain ||
-                        lhsData->nativeVlan != rhsData->nativeVlan || lhsData->duplex != rhsData->duplex || lhsData->trustBitmap != rhsData->trustBitmap || lhsData->untrustedPortCos != rhsData->untrustedPortCos ||
-                        lhsData->mgmtAddresses.addresses.size() != rhsData->mgmtAddresses.addresses.size() || !std::equal(lhsData->mgmtAddresses.addresses.begin(), lhsData->mgmtAddresses.addresses.end(), rhsData->mgmtAddresses.addresses.begin());
-        }
-
-        if (lhs->getProtocolType() == ProtocolType::LLDP) {
-            const LLDPData* lhsData = static_cast<const LLDPData*>(lhs.get());
-            const LLDPData* rhsData = static_cast<const LLDPData*>(rhs.get());
-            return lhsData->senderMAC != rhsData->senderMAC || lhsData->portID != rhsData->portID || lhsData->portDescription != rhsData->portDescription ||
-                   lhsData->systemName != rhsData->systemName || lhsData->systemDescription != rhsData->systemDescription;
-        }
-
-        if (lhs->getProtocolType() == ProtocolType::WOL) {
-            const WOLData* lhsData = static_cast<const WOLData*>(lhs.get());
-            const WOLData* rhsData = static_cast<const WOLData*>(rhs.get());
-            return lhsData->senderMAC != rhsData->senderMAC || lhsData->targetMAC != rhsData->targetMAC;
-        }
+    bool operator()(const LLDPData& lhsData, const LLDPData& rhsData) const {
+        return lhsData.senderMAC != rhsData.senderMAC || lhsData.portID != rhsData.portID || lhsData.portDescription != rhsData.portDescription ||
+               lhsData.systemName != rhsData.systemName || lhsData.systemDescription != rhsData.systemDescription;
+    }
 
-        return false; // Fallback case
+    bool operator()(const WOLData& lhsData, const WOLData& rhsData) const {
+        return lhsData.senderMAC != rhsData.senderMAC || lhsData.targetMAC != rhsData.targetMAC;
     }
 };
 
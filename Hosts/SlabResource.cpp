@@ -0,0 +1,149 @@
+#include "SlabResource.hpp"
+
+#include <algorithm>
+#include <new>
+
+struct SlabResource::Slab {
+    Slab* previous = nullptr;
+    Slab* next = nullptr;
+    // Freed blocks, each holding the address of the next one
+    void* freeList = nullptr;
+    uint32_t blockSize = 0;
+    uint32_t capacity = 0;
+    uint32_t used = 0;
+    // Blocks handed out at least once, the next one is carved after them
+    uint32_t carved = 0;
+    uint8_t sizeClass = 0;
+};
+
+namespace {
+
+// Blocks start after the slab header, aligned for any type
+constexpr size_t HeaderSize = 64;
+static_assert(HeaderSize % alignof(std::max_align_t) == 0, "misaligned blocks");
+
+} // namespace
+
+SlabResource::~SlabResource() {
+    for (Slab* head : heads) {
+        while (head != nullptr) {
+            Slab* next = head->next;
+            upstream->deallocate(head, SlabSize, SlabSize);
+            head = next;
+        }
+    }
+}
+
+SlabResource::Stats SlabResource::getStats() const {
+    Stats stats;
+    stats.bytesInUse = bytesInUse.load(std::memory_order_relaxed);
+    stats.bytesReserved = bytesReserved.load(std::memory_order_relaxed);
+    stats.slabs = slabs.load(std::memory_order_relaxed);
+    stats.largeAllocations = largeAllocations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+size_t SlabResource::classOf(size_t bytes) {
+    return std::lower_bound(Classes.begin(), Classes.end(), bytes) - Classes.begin();
+}
+
+void* SlabResource::do_allocate(size_t bytes, size_t alignment) {
+    if (isLarge(bytes, alignment)) {
+        void* pointer = upstream->allocate(bytes, alignment);
+        bytesInUse.fetch_add(bytes, std::memory_order_relaxed);
+        bytesReserved.fetch_add(bytes, std::memory_order_relaxed);
+        largeAllocations.fetch_add(1, std::memory_order_relaxed);
+        return pointer;
+    }
+    size_t sizeClass = classOf(bytes);
+    Slab* slab = heads[sizeClass];
+    if (slab == nullptr || slab->used == slab->capacity) {
+        slab = addSlab(sizeClass);
+    }
+
+    void* block;
+    if (slab->freeList != nullptr) {
+        block = slab->freeList;
+        slab->freeList = *static_cast<void**>(block);
+    } else {
+        block = reinterpret_cast<char*>(slab) + HeaderSize + size_t(slab->carved) * slab->blockSize;
+        slab->carved++;
+    }
+    slab->used++;
+    if (slab->used == slab->capacity) {
+        // Full, behind the slabs that still have free blocks
+        unlink(slab);
+        pushBack(slab);
+    }
+    bytesInUse.fetch_add(slab->blockSize, std::memory_order_relaxed);
+    return block;
+}
+
+void SlabResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    if (isLarge(bytes, alignment)) {
+        upstream->deallocate(pointer, bytes, alignment);
+        bytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+        bytesReserved.fetch_sub(bytes, std::memory_order_relaxed);
+        largeAllocations.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+    Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(pointer) & ~uintptr_t(SlabSize - 1));
+    bool wasFull = slab->used == slab->capacity;
+    *static_cast<void**>(pointer) = slab->freeList;
+    slab->freeList = pointer;
+    slab->used--;
+    bytesInUse.fetch_sub(slab->blockSize, std::memory_order_relaxed);
+
+    if (slab->used == 0 && heads[slab->sizeClass] != slab) {
+        // The head of the class has free blocks for the next requests, this slab is not needed
+        unlink(slab);
+        upstream->deallocate(slab, SlabSize, SlabSize);
+        slabs.fetch_sub(1, std::memory_order_relaxed);
+        bytesReserved.fetch_sub(SlabSize, std::memory_order_relaxed);
+    } else if (wasFull) {
+        unlink(slab);
+        pushFront(slab);
+    }
+}
+
+SlabResource::Slab* SlabResource::addSlab(size_t sizeClass) {
+    Slab* slab = new (upstream->allocate(SlabSize, SlabSize)) Slab();
+    slab->sizeClass = static_cast<uint8_t>(sizeClass);
+    slab->blockSize = Classes[sizeClass];
+    slab->capacity = static_cast<uint32_t>((SlabSize - HeaderSize) / slab->blockSize);
+    pushFront(slab);
+    slabs.fetch_add(1, std::memory_order_relaxed);
+    bytesReserved.fetch_add(SlabSize, std::memory_order_relaxed);
+    return slab;
+}
+
+void SlabResource::pushFront(Slab* slab) {
+    Slab*& head = heads[slab->sizeClass];
+    slab->previous = nullptr;
+    slab->next = head;
+    if (head != nullptr) {
+        head->previous = slab;
+    } else {
+        tails[slab->sizeClass] = slab;
+    }
+    head = slab;
+}
+
+void SlabResource::pushBack(Slab* slab) {
+    Slab*& tail = tails[slab->sizeClass];
+    slab->next = nullptr;
+    slab->previous = tail;
+    if (tail != nullptr) {
+        tail->next = slab;
+    } else {
+        heads[slab->sizeClass] = slab;
+    }
+    tail = slab;
+}
+
+void SlabResource::unlink(Slab* slab) {
+    (slab->previous != nullptr ? slab->previous->next : heads[slab->sizeClass]) = slab->next;
+    (slab->next != nullptr ? slab->next->previous : tails[slab->sizeClass]) = slab->previous;
+    slab->previous = nullptr;
+    slab->next = nullptr;
+}
@@ -0,0 +1,80 @@
+#ifndef SLAB_RESOURCE_HPP
+#define SLAB_RESOURCE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+/**
+ * @class SlabResource
+ *
+ * @brief Memory resource carving the small blocks of a host store out of fixed-size slabs.
+ *
+ * A request of up to MaxBlock bytes is rounded up to a size class and served from a slab of that
+ * class, a SlabSize block of the upstream resource aligned on its size, so that the slab of a
+ * block is found by masking the block address. Freed blocks go to the free list of their slab and
+ * are reused first, which keeps the observations and interface sets of the hosts packed together.
+ * A slab left without any block in use is handed back to the upstream resource as a whole, unless
+ * it is the one the next requests of its class are served from: the memory of the hosts aging out
+ * is returned in slabs rather than left scattered over the heap. Larger or over-aligned requests
+ * are passed to the upstream resource.
+ *
+ * The resource is not synchronized, it is used by the single writer of its HostManager; the
+ * statistics can be read from any thread. Every block must be freed before the resource is
+ * destroyed, the remaining slabs are then released.
+ */
+class SlabResource : public std::pmr::memory_resource {
+  public:
+    static constexpr size_t SlabSize = 64 << 10;
+    static constexpr size_t MaxBlock = 4096;
+
+    struct Stats {
+        // Bytes of the blocks in use, rounded up to their size class, and of the requests passed upstream
+        uint64_t bytesInUse = 0;
+        // Bytes held from the upstream resource: the slabs and the requests passed upstream
+        uint64_t bytesReserved = 0;
+        uint64_t slabs = 0;
+        uint64_t largeAllocations = 0;
+
+        // Share of the reserved bytes not in use
+        double fragmentation() const { return bytesReserved ? 1.0 - double(bytesInUse) / double(bytesReserved) : 0.0; }
+    };
+
+    explicit SlabResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) : upstream(upstream) {}
+    ~SlabResource() override;
+
+    SlabResource(const SlabResource&) = delete;
+    SlabResource& operator=(const SlabResource&) = delete;
+
+    // Any thread: the counters as of the last allocation or deallocation
+    Stats getStats() const;
+
+  private:
+    struct Slab;
+    static constexpr std::array<uint32_t, 16> Classes = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096};
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    static bool isLarge(size_t bytes, size_t alignment) { return bytes > MaxBlock || alignment > alignof(std::max_align_t); }
+    static size_t classOf(size_t bytes);
+    Slab* addSlab(size_t sizeClass);
+    // Slabs of a class are listed with the ones that have free blocks first
+    void pushFront(Slab* slab);
+    void pushBack(Slab* slab);
+    void unlink(Slab* slab);
+
+    std::pmr::memory_resource* upstream;
+    std::array<Slab*, Classes.size()> heads{};
+    std::array<Slab*, Classes.size()> tails{};
+
+    std::atomic<uint64_t> bytesInUse{0};
+    std::atomic<uint64_t> bytesReserved{0};
+    std::atomic<uint64_t> slabs{0};
+    std::atomic<uint64_t> largeAllocations{0};
+};
+
+#endif // SLAB_RESOURCE_HPP
@@ -0,0 +1,289 @@
+#include "SnapshotFile.hpp"
+#include "HostDumper.hpp"
+#include "ObservationCodec.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char Magic[8] = {'N', 'P', 'S', 'N', 'A', 'P', '\r', '\n'};
+constexpr size_t ProtocolCount = 8;
+
+struct Section {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t count;
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+    // Checksum of the bytes following the header
+    uint64_t checksum;
+    uint64_t sequence;
+    Section hosts;
+    Section strings;
+    Section observations[ProtocolCount];
+};
+
+struct HostRecord {
+    uint8_t mac[6];
+    // 0 when unknown, 4 or 6
+    uint8_t ipVersion;
+    uint8_t reserved;
+    uint8_t ip[16];
+    StringRef hostname;
+    // Interface names separated by commas
+    StringRef interfaces;
+    int64_t firstSeen;
+    int64_t lastSeen;
+    uint32_t firstSeenNs;
+    uint32_t lastSeenNs;
+    uint64_t sequence;
+};
+
+// Precedes the protocol fields of every observation
+struct ObservationHeader {
+    uint32_t host;
+    uint32_t size;
+    int64_t timestamp;
+    uint32_t timestampNs;
+    StringRef ingress;
+    // Lifetime announced by the protocol, the expiry date is not stored
+    uint32_t ttl;
+    uint32_t hits;
+    uint32_t firstSeenNs;
+    int64_t firstSeen;
+};
+
+static_assert(sizeof(FileHeader) == 8 + 4 + 4 + 8 + 8 + 8 + sizeof(Section) * (2 + ProtocolCount), "padded header");
+static_assert(sizeof(HostRecord) == 72, "padded host record");
+static_assert(sizeof(ObservationHeader) == 48, "padded observation header");
+
+// Unmaps the file when the load returns
+struct Mapping {
+    void* data = MAP_FAILED;
+    size_t length = 0;
+    ~Mapping() {
+        if (data != MAP_FAILED) {
+            munmap(data, length);
+        }
+    }
+};
+
+} // namespace
+
+void SnapshotFile::Encoder::add(const Host& host) {
+    uint32_t index = static_cast<uint32_t>(hostCount++);
+
+    HostRecord record{};
+    host.getMACAddress().copyTo(record.mac);
+    pcpp::IPAddress ip = host.getIPAddress();
+    if (ip.isIPv4() && !ip.isZero()) {
+        record.ipVersion = 4;
+        std::memcpy(record.ip, ip.getIPv4().toBytes(), 4);
+    } else if (ip.isIPv6()) {
+        record.ipVersion = 6;
+        std::memcpy(record.ip, ip.getIPv6().toBytes(), 16);
+    }
+    record.hostname = strings.intern(host.getHostName());
+    std::string interfaces;
+    for (const InternedString& interface : host.getInterfaces()) {
+        interfaces += (interfaces.empty() ? "" : ",") + interface.str();
+    }
+    record.interfaces = strings.intern(interfaces);
+    record.firstSeen = host.getFirstSeen().tv_sec;
+    record.firstSeenNs = static_cast<uint32_t>(host.getFirstSeen().tv_nsec);
+    record.lastSeen = host.getLastSeen().tv_sec;
+    record.lastSeenNs = static_cast<uint32_t>(host.getLastSeen().tv_nsec);
+    record.sequence = host.getSequence();
+    ObservationWriter(hosts).put(record);
+
+    host.forEachProtocolData([&](const Observation& observation) {
+        std::string fields;
+        ObservationWriter(fields, &strings).putFields(observation);
+
+        const ProtocolData& data = dataOf(observation);
+        ObservationHeader header{};
+        header.host = index;
+        header.size = static_cast<uint32_t>(fields.size());
+        header.timestamp = data.timestamp.tv_sec;
+        header.timestampNs = static_cast<uint32_t>(data.timestamp.tv_nsec);
+        header.ingress = strings.intern(data.ingress.str());
+        header.ttl = data.ttl;
+        header.hits = data.hits;
+        header.firstSeen = data.firstSeen.tv_sec;
+        header.firstSeenNs = static_cast<uint32_t>(data.firstSeen.tv_nsec);
+        size_t protocol = static_cast<size_t>(protocolOf(observation));
+        ObservationWriter(observations[protocol]).put(header);
+        observations[protocol] += fields;
+        observationCounts[protocol]++;
+    });
+}
+
+std::string SnapshotFile::Encoder::finish(uint64_t sequence) {
+    FileHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.headerSize = sizeof(FileHeader);
+    header.sequence = sequence;
+
+    uint64_t offset = sizeof(FileHeader);
+    header.hosts = {offset, hosts.size(), hostCount};
+    offset += hosts.size();
+    for (size_t protocol = 0; protocol < ProtocolCount; protocol++) {
+        header.observations[protocol] = {offset, observations[protocol].size(), observationCounts[protocol]};
+        offset += observations[protocol].size();
+    }
+    header.strings = {offset, strings.data().size(), strings.size()};
+    offset += strings.data().size();
+    header.fileSize = offset;
+
+    std::string image;
+    image.reserve(offset);
+    ObservationWriter(image).put(header);
+    image += hosts;
+    for (const std::string& section : observations) {
+        image += section;
+    }
+    image += strings.data();
+
+    uint64_t sum = checksum64(reinterpret_cast<const uint8_t*>(image.data()) + sizeof(FileHeader), image.size() - sizeof(FileHeader));
+    std::memcpy(&image[offsetof(FileHeader, checksum)], &sum, sizeof(sum));
+
+    *this = Encoder();
+    return image;
+}
+
+bool SnapshotFile::write(const std::string& path, const std::string& image) {
+    return writeFileAtomically(path, image);
+}
+
+SnapshotFile::LoadResult SnapshotFile::load(const std::string& path, const std::function<void(Host&&)>& onHost) {
+    auto start = std::chrono::steady_clock::now();
+    LoadResult result;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        result.error = std::strerror(errno);
+        return result;
+    }
+    struct stat status{};
+    Mapping mapping;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        mapping.length = static_cast<size_t>(status.st_size);
+        mapping.data = mmap(nullptr, mapping.length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping.data == MAP_FAILED) {
+        result.error = "unable to map the file";
+        return result;
+    }
+    madvise(mapping.data, mapping.length, MADV_SEQUENTIAL | MADV_WILLNEED);
+    const uint8_t* base = static_cast<const uint8_t*>(mapping.data);
+    result.bytes = mapping.length;
+
+    // Header, then the bounds of every section, then the contents
+    FileHeader header;
+    if (mapping.length < sizeof(FileHeader)) {
+        result.error = "file shorter than the header";
+        return result;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+        result.error = "not a snapshot file";
+        return result;
+    }
+    if (header.version != Version || header.headerSize != sizeof(FileHeader)) {
+        result.error = "unsupported snapshot version " + std::to_string(header.version);
+        return result;
+    }
+    if (header.fileSize != mapping.length) {
+        result.error = "truncated file";
+        return result;
+    }
+    auto inside = [&](const Section& section) {
+        return section.offset >= sizeof(FileHeader) && section.offset <= mapping.length && section.size <= mapping.length - section.offset;
+    };
+    bool valid = inside(header.hosts) && inside(header.strings) && header.hosts.size == header.hosts.count * sizeof(HostRecord);
+    for (const Section& section : header.observations) {
+        valid = valid && inside(section);
+    }
+    if (!valid) {
+        result.error = "section out of the file";
+        return result;
+    }
+    if (checksum64(base + sizeof(FileHeader), mapping.length - sizeof(FileHeader)) != header.checksum) {
+        result.error = "checksum mismatch";
+        return result;
+    }
+
+    const uint8_t* strings = base + header.strings.offset;
+    std::vector<Host> hosts;
+    try {
+        hosts.reserve(header.hosts.count);
+        for (uint64_t i = 0; i < header.hosts.count; i++) {
+            HostRecord record;
+            std::memcpy(&record, base + header.hosts.offset + i * sizeof(HostRecord), sizeof(record));
+            ObservationReader reader(nullptr, 0, strings, header.strings.size);
+            Host host(pcpp::MacAddress(record.mac), ObservationReader::toIp(record.ipVersion, record.ip), reader.resolve(record.hostname),
+                      {record.firstSeen, record.firstSeenNs}, {record.lastSeen, record.lastSeenNs});
+            std::string interfaces = reader.resolve(record.interfaces);
+            for (size_t begin = 0; begin < interfaces.size();) {
+                size_t end = std::min(interfaces.find(',', begin), interfaces.size());
+                host.addInterface(interfaces.substr(begin, end - begin));
+                begin = end + 1;
+            }
+            host.setSequence(record.sequence);
+            hosts.push_back(std::move(host));
+        }
+
+        for (size_t protocol = 0; protocol < ProtocolCount; protocol++) {
+            const Section& section = header.observations[protocol];
+            const uint8_t* data = base + section.offset;
+            size_t offset = 0;
+            for (uint64_t i = 0; i < section.count; i++) {
+                ObservationReader headerReader(data + offset, section.size - offset, strings, header.strings.size);
+                auto observation = headerReader.get<ObservationHeader>();
+                offset += sizeof(ObservationHeader);
+                if (observation.host >= hosts.size() || observation.size > section.size - offset) {
+                    throw std::out_of_range("observation out of its section");
+                }
+                ObservationReader reader(data + offset, observation.size, strings, header.strings.size);
+                timespec ts{observation.timestamp, observation.timestampNs};
+                Observation restored = reader.getFields(static_cast<ProtocolType>(protocol), ts);
+                ProtocolData& protocolData = dataOf(restored);
+                protocolData.ingress = InternedString(reader.resolve(observation.ingress));
+                protocolData.ttl = observation.ttl;
+                protocolData.hits = observation.hits;
+                protocolData.firstSeen = {observation.firstSeen, observation.firstSeenNs};
+                hosts[observation.host].updateProtocolData(std::move(restored));
+                offset += observation.size;
+                result.observations++;
+            }
+        }
+    } catch (const std::exception& e) {
+        result.error = std::string("invalid record: ") + e.what();
+        result.observations = 0;
+        return result;
+    }
+
+    for (Host& host : hosts) {
+        onHost(std::move(host));
+    }
+    result.loaded = true;
+    result.hosts = hosts.size();
+    result.sequence = header.sequence;
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
@@ -0,0 +1,83 @@
+#ifndef SNAPSHOT_FILE_HPP
+#define SNAPSHOT_FILE_HPP
+
+#include "Host.hpp"
+#include "ObservationCodec.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * @class SnapshotFile
+ *
+ * @brief Versioned binary image of the host store, to restart without rediscovering the hosts.
+ *
+ * The file starts with a fixed header holding the format version, the file size, a checksum
+ * of everything after the header and the offset of every section:
+ *  - a host section of fixed-size records (MAC, IP, hostname, interfaces, first and last seen,
+ *    sequence number of the last update);
+ *  - one observation section per protocol, each observation naming the host record it
+ *    belongs to and carrying its history counters and the protocol fields, in the order of
+ *    the host's history;
+ *  - a string table holding every string and byte list once, referenced by offset and length.
+ *
+ * Integers are stored in host byte order. A snapshot is loaded by mapping the file, checking
+ * the header, the section bounds and the checksum, then rebuilding the hosts from the records;
+ * a file failing any check, or any reference pointing outside its section, is rejected as a
+ * whole and nothing is loaded.
+ */
+class SnapshotFile {
+  public:
+    static constexpr uint32_t Version = 4;
+
+    /**
+     * @class Encoder
+     * @brief Accumulates hosts, of one or several shards, into a snapshot image.
+     */
+    class Encoder {
+      public:
+        // Encode a host and its observations
+        void add(const Host& host);
+        // Number of hosts encoded so far
+        size_t size() const { return hostCount; }
+        // Assemble the image, the encoder is left empty
+        std::string finish(uint64_t sequence);
+
+      private:
+        size_t hostCount = 0;
+        std::string hosts;
+        std::array<std::string, 8> observations;
+        std::array<uint64_t, 8> observationCounts{};
+        // Every string of the hosts and observations, stored once
+        StringTable strings;
+    };
+
+    struct LoadResult {
+        bool loaded = false;
+        // Reason the file was rejected
+        std::string error;
+        size_t hosts = 0;
+        size_t observations = 0;
+        size_t bytes = 0;
+        // Sequence number of the host updates when the snapshot was taken
+        uint64_t sequence = 0;
+        std::chrono::microseconds elapsed{0};
+    };
+
+    // Replace the snapshot file with an image, atomically
+    static bool write(const std::string& path, const std::string& image);
+
+    /**
+     * @brief Maps and validates a snapshot file, then hands every host it holds to a function.
+     *
+     * @param path The snapshot file.
+     * @param onHost Called with every host, only once the whole file is validated.
+     * @return The outcome, with the reason of the rejection if the file is missing or invalid.
+     */
+    static LoadResult load(const std::string& path, const std::function<void(Host&&)>& onHost);
+};
+
+#endif // SNAPSHOT_FILE_HPP
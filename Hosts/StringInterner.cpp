@@ -0,0 +1,136 @@
+#include "StringInterner.hpp"
+
+#include <functional>
+#include <stdexcept>
+
+StringInterner& StringInterner::global() {
+    static StringInterner* table = new StringInterner();
+    return *table;
+}
+
+uint32_t StringInterner::intern(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+    size_t shardIndex;
+    Shard& shard = shardFor(text, shardIndex);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return insert(shard, shardIndex, text);
+}
+
+uint32_t StringInterner::pin(std::string_view text) {
+    if (text.empty()) {
+        return 0;
+    }
+    size_t shardIndex;
+    Shard& shard = shardFor(text, shardIndex);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    uint32_t id = insert(shard, shardIndex, text);
+    // The references already held keep the same ID, a release racing with the pin cannot free it
+    entry(id).pinned.store(true, std::memory_order_relaxed);
+    return id;
+}
+
+StringInterner::Shard& StringInterner::shardFor(std::string_view text, size_t& shardIndex) {
+    size_t hash = std::hash<std::string_view>()(text);
+    shardIndex = (hash ^ (hash >> 32)) & (Shards - 1);
+    return shards[shardIndex];
+}
+
+uint32_t StringInterner::insert(Shard& shard, size_t shardIndex, std::string_view text) {
+    auto it = shard.index.find(text);
+    uint32_t id;
+    if (it != shard.index.end()) {
+        // The last reference may be dropping concurrently, it then finds the string in use again
+        id = it->second;
+        Entry& found = entry(id);
+        if (!found.pinned.load(std::memory_order_relaxed)) {
+            found.references.fetch_add(1, std::memory_order_relaxed);
+        }
+        return id;
+    }
+
+    id = idOf(shardIndex, allocateSlot(shard));
+    Entry& stored = entry(id);
+    stored.text.assign(text);
+    stored.references.store(1, std::memory_order_relaxed);
+    stored.live = true;
+    shard.index.emplace(stored.text, id);
+    shard.strings++;
+    shard.bytes += text.size();
+    return id;
+}
+
+void StringInterner::acquire(uint32_t id) {
+    if (id == 0) {
+        return;
+    }
+    Entry& held = entry(id);
+    if (!held.pinned.load(std::memory_order_relaxed)) {
+        held.references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StringInterner::release(uint32_t id) {
+    if (id == 0) {
+        return;
+    }
+    Entry& held = entry(id);
+    if (held.pinned.load(std::memory_order_relaxed) || held.references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    Shard& shard = shards[shardOf(id)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // Interned again or pinned meanwhile, or already freed by another thread that dropped it to zero
+    if (held.references.load(std::memory_order_relaxed) != 0 || held.pinned.load(std::memory_order_relaxed) || !held.live) {
+        return;
+    }
+    shard.index.erase(std::string_view(held.text));
+    shard.strings--;
+    shard.bytes -= held.text.size();
+    std::string().swap(held.text);
+    held.live = false;
+    uint32_t slot = slotOf(id);
+    held.nextFree = shard.freeList;
+    shard.freeList = slot;
+}
+
+StringInterner::Stats StringInterner::getStats() const {
+    Stats stats;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.strings += shard.strings;
+        stats.bytes += shard.bytes;
+        // The texts only change under the shard mutex, the reference counts are a moment's view
+        for (uint32_t slot = 0; slot < shard.slots; slot++) {
+            const Entry& stored = shard.chunks[slot >> ChunkBits].load(std::memory_order_relaxed)[slot & (ChunkSize - 1)];
+            if (!stored.live) {
+                continue;
+            }
+            uint64_t held = stored.references.load(std::memory_order_relaxed);
+            stats.references += held;
+            stats.referencedBytes += held * stored.text.size();
+        }
+    }
+    return stats;
+}
+
+uint32_t StringInterner::allocateSlot(Shard& shard) {
+    if (shard.freeList != NoSlot) {
+        uint32_t slot = shard.freeList;
+        shard.freeList = shard.chunks[slot >> ChunkBits].load(std::memory_order_relaxed)[slot & (ChunkSize - 1)].nextFree;
+        return slot;
+    }
+    uint32_t slot = shard.slots;
+    size_t chunk = slot >> ChunkBits;
+    if (chunk == MaxChunks) {
+        throw std::length_error("String table full");
+    }
+    if ((slot & (ChunkSize - 1)) == 0) {
+        // Published before any ID of the chunk is handed out
+        shard.chunks[chunk].store(new Entry[ChunkSize], std::memory_order_release);
+    }
+    shard.slots++;
+    return slot;
+}
@@ -0,0 +1,170 @@
+#ifndef STRING_INTERNER_HPP
+#define STRING_INTERNER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @class StringInterner
+ *
+ * @brief Process-wide table of the strings repeated across observations, each stored once.
+ *
+ * A string is interned into a 32-bit ID holding one reference to it; the text is freed when
+ * its last reference is released. The empty string is ID 0 and is never stored. Equal strings
+ * alive at the same time share the same ID, so comparing them is comparing their IDs.
+ *
+ * The table is split into shards by string hash, each behind its own mutex, so that the
+ * workers interning at once rarely contend. Resolving an ID back to its text takes no lock:
+ * the entries live in chunks that never move, and the text of an entry does not change while
+ * a reference to it is held. Copying a reference is a single atomic increment, of the entry:
+ * the counters are kept per shard under its mutex, and the references counted when reported.
+ *
+ * A pinned string, such as a capture interface stamped on every observation, is never freed
+ * and not reference counted: copying it only reads its entry, so the workers sharing it do
+ * not contend on its cache line.
+ */
+class StringInterner {
+  public:
+    struct Stats {
+        // Distinct strings stored, and their bytes
+        uint64_t strings = 0;
+        uint64_t bytes = 0;
+        // References held by the observations, and the bytes they would take stored in full
+        uint64_t references = 0;
+        uint64_t referencedBytes = 0;
+
+        // Bytes the references would take for every byte stored
+        double dedupRatio() const { return bytes ? double(referencedBytes) / double(bytes) : 1.0; }
+    };
+
+    // Shared by every HostManager, never destroyed so that no observation outlives it
+    static StringInterner& global();
+
+    StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // ID of a string, with one reference to it
+    uint32_t intern(std::string_view text);
+    // ID of a string kept for the life of the process, its references are not counted
+    uint32_t pin(std::string_view text);
+    // Add a reference to an ID already referenced by the caller
+    void acquire(uint32_t id);
+    // Drop a reference, freeing the string with its last one
+    void release(uint32_t id);
+    // Any thread: text of an ID the caller holds a reference to
+    std::string_view resolve(uint32_t id) const {
+        return id == 0 ? std::string_view() : std::string_view(entry(id).text);
+    }
+
+    // Any thread: the counters summed over the shards; the references are counted from the entries, for reports only
+    Stats getStats() const;
+
+  private:
+    static constexpr unsigned ShardBits = 4;
+    static constexpr size_t Shards = size_t(1) << ShardBits;
+    static constexpr unsigned ChunkBits = 12;
+    static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+    static constexpr size_t MaxChunks = 1024;
+    static constexpr uint32_t NoSlot = ~uint32_t(0);
+
+    struct Entry {
+        std::string text;
+        std::atomic<uint32_t> references{0};
+        // Never freed, set once under the shard mutex and read by acquire and release
+        std::atomic<bool> pinned{false};
+        // Whether the text is indexed, false once freed
+        bool live = false;
+        uint32_t nextFree = NoSlot;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string_view, uint32_t> index;
+        std::array<std::atomic<Entry*>, MaxChunks> chunks{};
+        // Slots handed out at least once, and the freed ones
+        uint32_t slots = 0;
+        uint32_t freeList = NoSlot;
+        // Strings stored in the shard, and their bytes
+        uint64_t strings = 0;
+        uint64_t bytes = 0;
+    };
+
+    // The ID packs the shard in its low bits and the slot plus one above, leaving 0 free
+    static uint32_t idOf(size_t shard, uint32_t slot) { return ((slot + 1) << ShardBits) | uint32_t(shard); }
+    static size_t shardOf(uint32_t id) { return id & (Shards - 1); }
+    static uint32_t slotOf(uint32_t id) { return (id >> ShardBits) - 1; }
+
+    Entry& entry(uint32_t id) const {
+        uint32_t slot = slotOf(id);
+        return shards[shardOf(id)].chunks[slot >> ChunkBits].load(std::memory_order_acquire)[slot & (ChunkSize - 1)];
+    }
+    uint32_t allocateSlot(Shard& shard);
+    // Find or store a string, with one reference to it unless pinned, under the shard mutex
+    uint32_t insert(Shard& shard, size_t shardIndex, std::string_view text);
+    Shard& shardFor(std::string_view text, size_t& shardIndex);
+
+    mutable std::array<Shard, Shards> shards;
+};
+
+/**
+ * @class InternedString
+ *
+ * @brief Reference to a string of the global StringInterner.
+ *
+ * Built from text like a std::string and read back through view() or str(); equality is an
+ * integer compare of the IDs.
+ */
+class InternedString {
+  public:
+    InternedString() = default;
+    InternedString(std::string_view text) : id(StringInterner::global().intern(text)) {}
+    InternedString(const std::string& text) : InternedString(std::string_view(text)) {}
+    InternedString(const char* text) : InternedString(std::string_view(text)) {}
+    // A string never freed, copied without touching its reference count
+    static InternedString pinned(std::string_view text) { return InternedString(StringInterner::global().pin(text), 0); }
+
+    InternedString(const InternedString& other) : id(other.id) { StringInterner::global().acquire(id); }
+    InternedString(InternedString&& other) noexcept : id(other.id) { other.id = 0; }
+    InternedString& operator=(const InternedString& other) {
+        StringInterner::global().acquire(other.id);
+        StringInterner::global().release(id);
+        id = other.id;
+        return *this;
+    }
+    InternedString& operator=(InternedString&& other) noexcept {
+        if (this != &other) {
+            StringInterner::global().release(id);
+            id = other.id;
+            other.id = 0;
+        }
+        return *this;
+    }
+    ~InternedString() { StringInterner::global().release(id); }
+
+    std::string_view view() const { return StringInterner::global().resolve(id); }
+    std::string str() const { return std::string(view()); }
+    uint32_t getId() const { return id; }
+    bool empty() const { return id == 0; }
+
+    bool operator==(const InternedString& other) const { return id == other.id; }
+    bool operator!=(const InternedString& other) const { return id != other.id; }
+
+  private:
+    InternedString(uint32_t id, int) : id(id) {}
+
+    uint32_t id = 0;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const InternedString& string) {
+    return os << string.view();
+}
+
+#endif // STRING_INTERNER_HPP
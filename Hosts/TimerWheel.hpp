@@ -0,0 +1,133 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TimerWheel
+ *
+ * @brief Hierarchical timer wheel of one-second ticks firing keys at their deadline.
+ *
+ * The wheel has Levels levels of Slots slots. Level 0 holds the timers due within the current
+ * block of Slots seconds, one slot per second; each higher level covers Slots times the span of
+ * the level below, one slot per block of it. A timer is placed on the lowest level whose block
+ * holds both the current second and its deadline, so scheduling is O(1). When the current
+ * second enters a new block of a level, the slot of that block is cascaded down the levels, so
+ * every timer moves at most Levels times before it fires: advancing is O(1) amortized per timer
+ * and per second. Deadlines past the top level wait in an overflow list until they come in range.
+ *
+ * Timers are not cancelled: the owner checks, when a key fires, that its deadline still stands,
+ * and schedules a new timer instead of moving one.
+ */
+class TimerWheel {
+  public:
+    struct Timer {
+        uint64_t key;
+        int64_t deadline;
+    };
+
+    static constexpr unsigned SlotBits = 6;
+    static constexpr size_t Slots = size_t(1) << SlotBits;
+    static constexpr unsigned Levels = 4;
+
+    // Schedule a key to fire at a second, at the earliest the one after the current second
+    void schedule(uint64_t key, int64_t deadline, int64_t now) {
+        if (count == 0 && now > current) {
+            current = now;
+        }
+        place({key, deadline > current ? deadline : current + 1});
+        count++;
+    }
+
+    /**
+     * @brief Moves the wheel up to a second, firing the timers due on the way.
+     *
+     * @param now The second to move to, nothing happens if the wheel is already past it.
+     * @param onExpired Called with the key and deadline of every timer due, in deadline order.
+     *        It may schedule new timers.
+     * @return The number of timers fired.
+     */
+    template <typename Function>
+    size_t advance(int64_t now, Function&& onExpired) {
+        if (count == 0) {
+            current = now > current ? now : current;
+            return 0;
+        }
+        size_t fired = 0;
+        while (current < now && count > 0) {
+            current++;
+            cascade();
+            std::vector<Timer>& slot = levels[0][current & (Slots - 1)];
+            if (slot.empty()) {
+                continue;
+            }
+            firing.swap(slot);
+            count -= firing.size();
+            for (const Timer& timer : firing) {
+                onExpired(timer.key, timer.deadline);
+            }
+            fired += firing.size();
+            firing.clear();
+        }
+        if (count == 0 && now > current) {
+            current = now;
+        }
+        return fired;
+    }
+
+    // Scheduled timers, including those whose deadline no longer stands
+    size_t size() const { return count; }
+    // Last second the wheel moved to
+    int64_t getCurrent() const { return current; }
+
+  private:
+    static constexpr unsigned RangeBits = SlotBits * Levels;
+
+    void place(const Timer& timer) {
+        for (unsigned level = 0; level < Levels; level++) {
+            unsigned shift = SlotBits * (level + 1);
+            if ((timer.deadline >> shift) == (current >> shift)) {
+                levels[level][(timer.deadline >> (SlotBits * level)) & (Slots - 1)].push_back(timer);
+                return;
+            }
+        }
+        overflow.push_back(timer);
+    }
+
+    // Move the timers of the blocks the current second enters to the lower levels, top level first
+    void cascade() {
+        if ((current & ((int64_t(1) << RangeBits) - 1)) == 0 && !overflow.empty()) {
+            redistribute(overflow);
+        }
+        for (unsigned level = Levels - 1; level > 0; level--) {
+            unsigned shift = SlotBits * level;
+            if ((current & ((int64_t(1) << shift) - 1)) != 0) {
+                continue;
+            }
+            std::vector<Timer>& slot = levels[level][(current >> shift) & (Slots - 1)];
+            if (!slot.empty()) {
+                redistribute(slot);
+            }
+        }
+    }
+
+    void redistribute(std::vector<Timer>& timers) {
+        std::vector<Timer> moving;
+        moving.swap(timers);
+        for (const Timer& timer : moving) {
+            place(timer);
+        }
+    }
+
+    std::array<std::array<std::vector<Timer>, Slots>, Levels> levels;
+    std::vector<Timer> overflow;
+    // Timers of the slot being fired, kept to reuse its capacity
+    std::vector<Timer> firing;
+    int64_t current = 0;
+    size_t count = 0;
+};
+
+#endif // TIMER_WHEEL_HPP
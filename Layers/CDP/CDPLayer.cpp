@@ -1,10 +1,31 @@
 #include "CDPLayer.hpp"
 
-CDPLayer::CDPLayer(const uint8_t* data, size_t dataLen) : rawData(data), rawDataLength(dataLen) {
+namespace {
+
+// Whether text is raw with its newlines removed, as getSoftwareVersion() and getPlatform() return it
+bool equalsWithoutNewlines(std::string_view raw, std::string_view text) {
+    size_t position = 0;
+    for (char c : raw) {
+        if (c == '\n') {
+            continue;
+        }
+        if (position == text.size() || text[position] != c) {
+            return false;
+        }
+        position++;
+    }
+    return position == text.size();
+}
+
+} // namespace
+
+CDPLayer::CDPLayer(const uint8_t* data, size_t dataLen, std::pmr::memory_resource* scratch)
+    : rawData(data), rawDataLength(dataLen), tlvResource(tlvBuffer, sizeof(tlvBuffer), scratch), tlvs(&tlvResource) {
     // Check if the data length is valid for CDP
     if (dataLen < 4) {
         throw std::invalid_argument("Invalid CDPDU size");
     }
+    tlvs.reserve(InlineTlvs);
 
     // Parse TLVs
     parseTLVs();
@@ -71,46 +92,30 @@ struct CDPLayer::DeviceId CDPLayer::getDeviceId() const {
 }
 
 struct CDPLayer::Addresses CDPLayer::getAddresses() const {
-    TLV tlv = getTLV(CDP_TLV_TYPE_ADDRESS);
-    Addresses addresses;
-
-    // Ensure the TLV has a valid length
-    if (tlv.length < 1) {
-        return addresses;
-    }
-
-    // Extract the number of addresses offset 4 bytes and convert to integer
-    addresses.numberOfAddresses = tlv.value[4] << 24 | tlv.value[5] << 16 | tlv.value[6] << 8 | tlv.value[7];
-   
-
-    // Ensure the TLV has a valid length
-    if (tlv.length < 1 + addresses.numberOfAddresses * 5) {
-        return addresses;
-    }
-
-    // Extract the addresses
-    for (size_t i = 0; i < addresses.numberOfAddresses; i++) {
-        Address address;
-        address.protocolType = tlv.value[8 + i * 5];
-        address.protocolLength = tlv.value[9 + i * 5];
-        address.protocol = tlv.value[10 + i * 5];
-        address.addressLength = tlv.value[11 + i * 5] << 8 | tlv.value[12 + i * 5];
-        address.address = tlv.value + 13 + i * 5;
+    Addresses addresses{{}, 0};
+    addresses.numberOfAddresses = forEachAddress(CDP_TLV_TYPE_ADDRESS, [&addresses](const Address& address) {
         addresses.addresses.push_back(address);
-    }
-
+    });
     return addresses;
 }
 
-std::string CDPLayer::getPortId() const {
-    TLV tlv = getTLV(CDP_TLV_TYPE_PORT_ID);
+std::string_view CDPLayer::getText(uint8_t type) const {
+    TLV tlv = getTLV(type);
 
     // Ensure the TLV has a valid length
     if (tlv.length < 1) {
-        return "";
+        return {};
     }
 
-    return std::string(reinterpret_cast<const char*>(tlv.value), tlv.length);
+    return std::string_view(reinterpret_cast<const char*>(tlv.value), tlv.length);
+}
+
+std::string_view CDPLayer::getPortIdView() const {
+    return getText(CDP_TLV_TYPE_PORT_ID);
+}
+
+std::string CDPLayer::getPortId() const {
+    return std::string(getPortIdView());
 }
 
 uint32_t CDPLayer::getCapabilities() const {
@@ -125,19 +130,19 @@ uint32_t CDPLayer::getCapabilities() const {
 }
 
 std::string CDPLayer::capabilitiesToString(uint32_t capabilities) const {
-    std::ostringstream oss;
-    if (capabilities & CAPABILITY_ROUTER) oss << "Router ";
-    if (capabilities & CAPABILITY_TRANSPARENT_BRIDGE) oss << "Transparent Bridge ";
-    if (capabilities & CAPABILITY_SOURCE_ROUTE_BRIDGE) oss << "Source Route Bridge ";
-    if (capabilities & CAPABILITY_SWITCH) oss << "Switch ";
-    if (capabilities & CAPABILITY_HOST) oss << "Host ";
-    if (capabilities & CAPABILITY_IGMP) oss << "IGMP ";
-    if (capabilities & CAPABILITY_REPEATER) oss << "Repeater ";
-    if (capabilities & CAPABILITY_VOIP_PHONE) oss << "VoIP Phone ";
-    if (capabilities & CAPABILITY_REMOTELY_MANAGED) oss << "Remotely Managed ";
-    if (capabilities & CAPABILITY_CVTA) oss << "CVTA ";
-    if (capabilities & CAPABILITY_TWO_PORT_MAC_RELAY) oss << "Two Port MAC Relay ";
-    return oss.str();
+    std::string names;
+    if (capabilities & CAPABILITY_ROUTER) names += "Router ";
+    if (capabilities & CAPABILITY_TRANSPARENT_BRIDGE) names += "Transparent Bridge ";
+    if (capabilities & CAPABILITY_SOURCE_ROUTE_BRIDGE) names += "Source Route Bridge ";
+    if (capabilities & CAPABILITY_SWITCH) names += "Switch ";
+    if (capabilities & CAPABILITY_HOST) names += "Host ";
+    if (capabilities & CAPABILITY_IGMP) names += "IGMP ";
+    if (capabilities & CAPABILITY_REPEATER) names += "Repeater ";
+    if (capabilities & CAPABILITY_VOIP_PHONE) names += "VoIP Phone ";
+    if (capabilities & CAPABILITY_REMOTELY_MANAGED) names += "Remotely Managed ";
+    if (capabilities & CAPABILITY_CVTA) names += "CVTA ";
+    if (capabilities & CAPABILITY_TWO_PORT_MAC_RELAY) names += "Two Port MAC Relay ";
+    return names;
 }
 
 std::string CDPLayer::getSoftwareVersion() const {
@@ -180,15 +185,31 @@ std::string CDPLayer::getPlatform() const {
     return platform;
 }
 
+std::string_view CDPLayer::getVTPManagementDomainView() const {
+    return getText(CDP_TLV_TYPE_VTP_MANAGEMENT_DOMAIN);
+}
+
 std::string CDPLayer::getVTPManagementDomain() const {
-    TLV tlv = getTLV(CDP_TLV_TYPE_VTP_MANAGEMENT_DOMAIN);
+    return std::string(getVTPManagementDomainView());
+}
 
-    // Ensure the TLV has a valid length
-    if (tlv.length < 1) {
-        return "";
+bool CDPLayer::deviceIdEquals(DeviceIdSubtype subtype, std::string_view id) const {
+    TLV tlv = getTLV(CDP_TLV_TYPE_DEVICE_ID);
+
+    // Without a valid TLV, getDeviceId() leaves the subtype unset: never equal
+    if (tlv.length < 2) {
+        return false;
     }
 
-    return std::string(reinterpret_cast<const char*>(tlv.value), tlv.length);
+    return tlv.value[0] == subtype && std::string_view(reinterpret_cast<const char*>(tlv.value + 1), tlv.length - 1) == id;
+}
+
+bool CDPLayer::softwareVersionEquals(std::string_view softwareVersion) const {
+    return equalsWithoutNewlines(getText(CDP_TLV_TYPE_SOFTWARE_VERSION), softwareVersion);
+}
+
+bool CDPLayer::platformEquals(std::string_view platform) const {
+    return equalsWithoutNewlines(getText(CDP_TLV_TYPE_PLATFORM), platform);
 }
 
 uint8_t CDPLayer::getDuplex() const {
@@ -236,33 +257,10 @@ uint8_t CDPLayer::getUntrustedPortCos() const {
 }
 
 struct CDPLayer::Addresses CDPLayer::getMgmtAddresses() const {
-    TLV tlv = getTLV(CDP_TLV_TYPE_MGMT_ADDRESS);
-    Addresses addresses;
-
-    // Ensure the TLV has a valid length
-    if (tlv.length < 1) {
-        return addresses;
-    }
-
-    // Extract the number of addresses offset 4 bytes and convert to integer
-    addresses.numberOfAddresses = tlv.value[4] << 24 | tlv.value[5] << 16 | tlv.value[6] << 8 | tlv.value[7];
-
-    // Ensure the TLV has a valid length
-    if (tlv.length < 1 + addresses.numberOfAddresses * 5) {
-        return addresses;
-    }
-
-    // Extract the addresses
-    for (size_t i = 0; i < addresses.numberOfAddresses; i++) {
-        Address address;
-        address.protocolType = tlv.value[8 + i * 5];
-        address.protocolLength = tlv.value[9 + i * 5];
-        address.protocol = tlv.value[10 + i * 5];
-        address.addressLength = tlv.value[11 + i * 5] << 8 | tlv.value[12 + i * 5];
-        address.address = tlv.value + 13 + i * 5;
+    Addresses addresses{{}, 0};
+    addresses.numberOfAddresses = forEachAddress(CDP_TLV_TYPE_MGMT_ADDRESS, [&addresses](const Address& address) {
         addresses.addresses.push_back(address);
-    }
-
+    });
     return addresses;
 }
 
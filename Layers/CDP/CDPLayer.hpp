@@ -2,7 +2,10 @@
 #define CDPLAYER_HPP
 
 #include <arpa/inet.h>
+#include <cstddef>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <unordered_map>
@@ -21,13 +24,20 @@
  * system description, system capabilities, and management address from the CDP packet.
  * 
  * The CDPLayer class also provides an overloaded operator for outputting CDP layer information.
+ *
+ * The TLV index of a common CDPDU fits in the layer itself, longer ones spill over to the
+ * scratch resource: parsing a frame does not touch the heap.
  */
 class CDPLayer {
 public:
     // Constructor and Destructor
-    CDPLayer(const uint8_t* data, size_t dataLen);
+    CDPLayer(const uint8_t* data, size_t dataLen, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
     ~CDPLayer();
 
+    // The TLV index points into the layer itself
+    CDPLayer(const CDPLayer&) = delete;
+    CDPLayer& operator=(const CDPLayer&) = delete;
+
     enum CDPTlvType {
         CDP_TLV_TYPE_DEVICE_ID = 0x0001,
         CDP_TLV_TYPE_ADDRESS = 0x0002,
@@ -108,6 +118,44 @@ public:
     struct CDPLayer::Addresses getMgmtAddresses() const;
     uint16_t getTTL() const;
 
+    // The text fields as views into the frame, without the copies of the getters above
+    std::string_view getPortIdView() const;
+    std::string_view getVTPManagementDomainView() const;
+    // Whether the getters would return these values, without copying them
+    bool deviceIdEquals(DeviceIdSubtype subtype, std::string_view id) const;
+    bool softwareVersionEquals(std::string_view softwareVersion) const;
+    bool platformEquals(std::string_view platform) const;
+
+    // Call a function with each address of an address TLV, without collecting them; returns the announced count
+    template <typename Function>
+    uint32_t forEachAddress(CDPTlvType type, Function&& function) const {
+        TLV tlv = getTLV(type);
+
+        // Ensure the TLV has a valid length
+        if (tlv.length < 1) {
+            return 0;
+        }
+
+        // Extract the number of addresses offset 4 bytes and convert to integer
+        uint32_t count = tlv.value[4] << 24 | tlv.value[5] << 16 | tlv.value[6] << 8 | tlv.value[7];
+
+        // Ensure the TLV has a valid length
+        if (tlv.length < 1 + count * 5) {
+            return count;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            Address address;
+            address.protocolType = tlv.value[8 + i * 5];
+            address.protocolLength = tlv.value[9 + i * 5];
+            address.protocol = tlv.value[10 + i * 5];
+            address.addressLength = tlv.value[11 + i * 5] << 8 | tlv.value[12 + i * 5];
+            address.address = tlv.value + 13 + i * 5;
+            function(address);
+        }
+        return count;
+    }
+
     // Overloaded operator for outputting CDP layer information
     friend std::ostream& operator<<(std::ostream& os, const CDPLayer& layer);
 
@@ -119,11 +167,16 @@ private:
     // Helper functions
     void parseTLVs();
     TLV getTLV(uint8_t type) const;
+    // Value of a TLV as text, empty if the TLV is missing
+    std::string_view getText(uint8_t type) const;
 
-    // Data structures for storing parsed TLVs
-    std::vector<TLV> tlvs;
+    // Data structures for storing parsed TLVs, the first InlineTlvs ones in the layer
+    static constexpr size_t InlineTlvs = 16;
+    alignas(TLV) std::byte tlvBuffer[InlineTlvs * sizeof(TLV)];
+    std::pmr::monotonic_buffer_resource tlvResource;
+    std::pmr::vector<TLV> tlvs;
 
-    const std::unordered_map<uint32_t, std::string> capabilitiesMap = {
+    static inline const std::unordered_map<uint32_t, std::string> capabilitiesMap = {
         {CAPABILITY_ROUTER, "Router"},
         {CAPABILITY_TRANSPARENT_BRIDGE, "Transparent Bridge"},
         {CAPABILITY_SOURCE_ROUTE_BRIDGE, "Source Route Bridge"},
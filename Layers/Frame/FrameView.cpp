@@ -0,0 +1,183 @@
+#include "FrameView.hpp"
+
+#include <stdexcept>
+
+FrameView::FrameView(const pcpp::RawPacket& rawPacket)
+    : FrameView(rawPacket.getRawData(), rawPacket.getRawDataLen(), rawPacket.getPacketTimeStamp()) {}
+
+FrameView::FrameView(const uint8_t* data, size_t length, const timespec& timestamp)
+    : data(data), length(length), timestamp(timestamp) {
+    if (!hasEthernet()) {
+        return;
+    }
+
+    size_t offset = 12;
+    uint16_t type = (data[offset] << 8) | data[offset + 1];
+    // Skip 802.1Q / 802.1ad tags, remembering where the outermost ones are
+    while ((type == 0x8100 || type == 0x88a8) && length >= offset + 6) {
+        if (vlanCount < MaxVlanTags) {
+            vlanOffsets[vlanCount] = offset + 2;
+        }
+        vlanCount++;
+        offset += 4;
+        type = (data[offset] << 8) | data[offset + 1];
+    }
+    l2Offset = offset + 2;
+
+    // 802.3 length field, the payload starts with an LLC header
+    if (type <= 1500) {
+        snap = length >= l2Offset + 8 && data[l2Offset] == 0xaa && data[l2Offset + 1] == 0xaa && data[l2Offset + 2] == 0x03;
+        return;
+    }
+    etherType = type;
+    l3Offset = l2Offset;
+
+    uint8_t protocol = 0;
+    if (etherType == 0x0800 && length >= l3Offset + 20 && data[l3Offset] >> 4 == 4 && (data[l3Offset] & 0x0f) >= 5) {
+        ipv4 = true;
+        protocol = data[l3Offset + 9];
+        // Only the first fragment carries the UDP header
+        bool firstFragment = (((data[l3Offset + 6] << 8) | data[l3Offset + 7]) & 0x1fff) == 0;
+        l4Offset = l3Offset + (data[l3Offset] & 0x0f) * 4;
+        udp = protocol == 17 && firstFragment;
+    } else if (etherType == 0x86dd && length >= l3Offset + 40) {
+        ipv6 = true;
+        protocol = data[l3Offset + 6];
+        l4Offset = l3Offset + 40;
+        udp = protocol == 17;
+    }
+    udp = udp && length >= l4Offset + 8;
+}
+
+void FrameView::require(size_t offset, size_t count) const {
+    if (offset + count > length || offset + count < offset) {
+        throw std::out_of_range("FrameView: read past the end of the frame");
+    }
+}
+
+uint8_t FrameView::readUInt8(size_t offset) const {
+    require(offset, 1);
+    return data[offset];
+}
+
+uint16_t FrameView::readUInt16(size_t offset) const {
+    require(offset, 2);
+    return (data[offset] << 8) | data[offset + 1];
+}
+
+uint32_t FrameView::readUInt32(size_t offset) const {
+    require(offset, 4);
+    return (uint32_t(data[offset]) << 24) | (data[offset + 1] << 16) | (data[offset + 2] << 8) | data[offset + 3];
+}
+
+pcpp::MacAddress FrameView::getDstMac() const {
+    require(0, 6);
+    return pcpp::MacAddress(data);
+}
+
+pcpp::MacAddress FrameView::getSrcMac() const {
+    require(6, 6);
+    return pcpp::MacAddress(data + 6);
+}
+
+uint16_t FrameView::getVlanId(size_t index) const {
+    if (index >= vlanCount || index >= MaxVlanTags) {
+        throw std::out_of_range("FrameView: no such VLAN tag");
+    }
+    return readUInt16(vlanOffsets[index]) & 0x0fff;
+}
+
+uint8_t FrameView::getDsap() const {
+    if (!hasLlc()) {
+        throw std::out_of_range("FrameView: not an LLC frame");
+    }
+    return data[l2Offset];
+}
+
+uint8_t FrameView::getSsap() const {
+    if (!hasLlc()) {
+        throw std::out_of_range("FrameView: not an LLC frame");
+    }
+    return data[l2Offset + 1];
+}
+
+uint8_t FrameView::getControl() const {
+    if (!hasLlc()) {
+        throw std::out_of_range("FrameView: not an LLC frame");
+    }
+    return data[l2Offset + 2];
+}
+
+uint32_t FrameView::getSnapOui() const {
+    if (!snap) {
+        throw std::out_of_range("FrameView: not a SNAP frame");
+    }
+    return (data[l2Offset + 3] << 16) | (data[l2Offset + 4] << 8) | data[l2Offset + 5];
+}
+
+uint16_t FrameView::getSnapPid() const {
+    if (!snap) {
+        throw std::out_of_range("FrameView: not a SNAP frame");
+    }
+    return (data[l2Offset + 6] << 8) | data[l2Offset + 7];
+}
+
+pcpp::IPv4Address FrameView::getSrcIPv4() const {
+    if (!ipv4) {
+        throw std::out_of_range("FrameView: not an IPv4 frame");
+    }
+    return pcpp::IPv4Address(data + l3Offset + 12);
+}
+
+pcpp::IPv4Address FrameView::getDstIPv4() const {
+    if (!ipv4) {
+        throw std::out_of_range("FrameView: not an IPv4 frame");
+    }
+    return pcpp::IPv4Address(data + l3Offset + 16);
+}
+
+uint8_t FrameView::getIpProtocol() const {
+    if (ipv4) {
+        return data[l3Offset + 9];
+    }
+    if (ipv6) {
+        return data[l3Offset + 6];
+    }
+    throw std::out_of_range("FrameView: not an IP frame");
+}
+
+uint16_t FrameView::getSrcPort() const {
+    if (!udp) {
+        throw std::out_of_range("FrameView: not a UDP frame");
+    }
+    return (data[l4Offset] << 8) | data[l4Offset + 1];
+}
+
+uint16_t FrameView::getDstPort() const {
+    if (!udp) {
+        throw std::out_of_range("FrameView: not a UDP frame");
+    }
+    return (data[l4Offset + 2] << 8) | data[l4Offset + 3];
+}
+
+const uint8_t* FrameView::getL2Payload() const {
+    if (!hasEthernet()) {
+        throw std::out_of_range("FrameView: not an Ethernet frame");
+    }
+    return data + l2Offset;
+}
+
+size_t FrameView::getL2PayloadLength() const {
+    return hasEthernet() ? length - l2Offset : 0;
+}
+
+const uint8_t* FrameView::getUdpPayload() const {
+    if (!udp) {
+        throw std::out_of_range("FrameView: not a UDP frame");
+    }
+    return data + l4Offset + 8;
+}
+
+size_t FrameView::getUdpPayloadLength() const {
+    return udp ? length - l4Offset - 8 : 0;
+}
@@ -0,0 +1,104 @@
+#ifndef FRAME_VIEW_HPP
+#define FRAME_VIEW_HPP
+
+#include "MacAddress.h"
+#include "IpAddress.h"
+#include "RawPacket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+/**
+ * @class FrameView
+ *
+ * @brief Read-only view over the headers of a raw Ethernet frame.
+ *
+ * The FrameView locates the Ethernet, 802.1Q, 802.3 LLC/SNAP, IPv4/IPv6 and UDP headers of a
+ * frame in a single pass over the raw bytes, without copying them nor allocating any layer.
+ * Analyzers that only need a few fixed fields use it instead of a parsed pcpp::Packet.
+ *
+ * The view does not own the frame, which must outlive it. Every accessor is bounds checked:
+ * reading a header the frame does not carry, or past the captured length, throws
+ * std::out_of_range, so a truncated frame is rejected like a malformed PDU.
+ */
+class FrameView {
+public:
+    FrameView(const uint8_t* data, size_t length, const timespec& timestamp);
+    explicit FrameView(const pcpp::RawPacket& rawPacket);
+
+    // Raw frame
+    const uint8_t* getData() const { return data; }
+    size_t getLength() const { return length; }
+    const timespec& getTimestamp() const { return timestamp; }
+
+    // Ethernet header
+    bool hasEthernet() const { return length >= 14; }
+    pcpp::MacAddress getDstMac() const;
+    pcpp::MacAddress getSrcMac() const;
+    // Ethertype after the VLAN tags, 0 for 802.3 frames
+    uint16_t getEtherType() const { return etherType; }
+
+    // 802.1Q / 802.1ad tags, outermost first
+    size_t getVlanCount() const { return vlanCount; }
+    uint16_t getVlanId(size_t index) const;
+
+    // 802.3 frame with an 802.2 LLC header, and optionally SNAP
+    bool isDot3() const { return hasEthernet() && etherType == 0; }
+    bool hasLlc() const { return isDot3() && length >= l2Offset + 3; }
+    uint8_t getDsap() const;
+    uint8_t getSsap() const;
+    uint8_t getControl() const;
+    bool hasSnap() const { return snap; }
+    uint32_t getSnapOui() const;
+    uint16_t getSnapPid() const;
+
+    // IPv4 or IPv6 header
+    bool hasIPv4() const { return ipv4; }
+    bool hasIPv6() const { return ipv6; }
+    pcpp::IPv4Address getSrcIPv4() const;
+    pcpp::IPv4Address getDstIPv4() const;
+    // IPv4 protocol or IPv6 next header
+    uint8_t getIpProtocol() const;
+
+    // UDP header, only on unfragmented datagrams or first fragments
+    bool hasUdp() const { return udp; }
+    uint16_t getSrcPort() const;
+    uint16_t getDstPort() const;
+
+    // Bytes after the ethertype (or the 802.3 length field), LLC header included
+    const uint8_t* getL2Payload() const;
+    size_t getL2PayloadLength() const;
+    // Bytes after the UDP header
+    const uint8_t* getUdpPayload() const;
+    size_t getUdpPayloadLength() const;
+
+    // Big-endian reads at an offset from the start of the frame
+    uint8_t readUInt8(size_t offset) const;
+    uint16_t readUInt16(size_t offset) const;
+    uint32_t readUInt32(size_t offset) const;
+
+private:
+    static constexpr size_t MaxVlanTags = 2;
+
+    // Throw unless the frame holds count bytes at offset
+    void require(size_t offset, size_t count) const;
+
+    const uint8_t* data;
+    size_t length;
+    timespec timestamp;
+
+    uint16_t etherType = 0;
+    size_t vlanCount = 0;
+    size_t vlanOffsets[MaxVlanTags] = {};
+    // Offsets of the L2 payload, the L3 header and the UDP header
+    size_t l2Offset = 0;
+    size_t l3Offset = 0;
+    size_t l4Offset = 0;
+    bool snap = false;
+    bool ipv4 = false;
+    bool ipv6 = false;
+    bool udp = false;
+};
+
+#endif // FRAME_VIEW_HPP
@@ -2,13 +2,46 @@
 #include <stdexcept>
 #include <iostream>
 #include <iomanip>
+#include <cstdio>
+
+namespace {
+
+// Colon separated hex bytes, e.g. a MAC address
+std::string toHexBytes(const uint8_t* bytes, size_t length) {
+    std::string text(length ? length * 3 - 1 : 0, ':');
+    for (size_t i = 0; i < length; i++) {
+        char digits[3];
+        std::snprintf(digits, sizeof(digits), "%02x", bytes[i]);
+        text[i * 3] = digits[0];
+        text[i * 3 + 1] = digits[1];
+    }
+    return text;
+}
+
+// Whether text holds the colon separated hex bytes toHexBytes() formats
+bool hexBytesEqual(const uint8_t* bytes, size_t length, std::string_view text) {
+    static const char digits[] = "0123456789abcdef";
+    if (text.size() != (length ? length * 3 - 1 : 0)) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (text[i * 3] != digits[bytes[i] >> 4] || text[i * 3 + 1] != digits[bytes[i] & 0x0f]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
 // Constructor
-LLDPLayer::LLDPLayer(const uint8_t* data, size_t dataLen) : rawData(data), rawDataLength(dataLen) {
+LLDPLayer::LLDPLayer(const uint8_t* data, size_t dataLen, std::pmr::memory_resource* scratch)
+    : rawData(data), rawDataLength(dataLen), tlvResource(tlvBuffer, sizeof(tlvBuffer), scratch), tlvs(&tlvResource) {
     // Check if the data length is valid for LLDP
     if (dataLen < 2) {
         throw std::invalid_argument("Invalid LLDPDU size");
     }
+    tlvs.reserve(InlineTlvs);
 
     // Parse TLVs
     parseTLVs();
@@ -80,14 +113,7 @@ struct LLDPLayer::Chassis LLDPLayer::getChassis() const {
    // If MAC address, convert to string
     std::string value;
     if (subtype == CHASSIS_ID_SUBTYPE_MAC_ADDRESS) {
-        std::stringstream ss;
-        for (size_t i = 1; i < tlv.length; i++) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << (int)tlv.value[i];
-            if (i < tlv.length - 1) {
-                ss << ":";
-            }
-        }
-        value = ss.str();
+        value = toHexBytes(tlv.value + 1, tlv.length - 1);
     } else {
         value = std::string(reinterpret_cast<const char*>(tlv.value + 1), tlv.length - 1);
     }
@@ -107,14 +133,7 @@ std::string LLDPLayer::getPortId() const {
 
     // If MAC address, convert to string
     if (subtype == PORT_ID_SUBTYPE_MAC_ADDRESS) {
-        std::stringstream ss;
-        for (size_t i = 1; i < tlv.length; i++) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << (int)tlv.value[i];
-            if (i < tlv.length - 1) {
-                ss << ":";
-            }
-        }
-        value = ss.str();
+        value = toHexBytes(tlv.value + 1, tlv.length - 1);
     } else {
         value = std::string(reinterpret_cast<const char*>(tlv.value + 1), tlv.length - 1);
     }
@@ -122,13 +141,43 @@ std::string LLDPLayer::getPortId() const {
     return value;
 }
 
-std::string LLDPLayer::getSystemName() const {
-    TLV tlv = getTLV(LLDP_TLV_TYPE_SYSTEM_NAME);
+bool LLDPLayer::portIdEquals(std::string_view portId) const {
+    TLV tlv = getTLV(LLDP_TLV_TYPE_PORT_ID);
     if (tlv.length == 0) {
-        return "";
+        return portId.empty();
+    }
+
+    // Same subtypes as getPortId()
+    PortSubtype subtype = static_cast<PortSubtype>(tlv.value[0]);
+    if (subtype == PORT_ID_SUBTYPE_MAC_ADDRESS) {
+        return hexBytesEqual(tlv.value + 1, tlv.length - 1, portId);
+    }
+    return std::string_view(reinterpret_cast<const char*>(tlv.value + 1), tlv.length - 1) == portId;
+}
+
+std::string_view LLDPLayer::getText(uint8_t type) const {
+    TLV tlv = getTLV(type);
+    if (tlv.length == 0) {
+        return {};
     }
 
-    return std::string(reinterpret_cast<const char*>(tlv.value), tlv.length);
+    return std::string_view(reinterpret_cast<const char*>(tlv.value), tlv.length);
+}
+
+std::string_view LLDPLayer::getSystemNameView() const {
+    return getText(LLDP_TLV_TYPE_SYSTEM_NAME);
+}
+
+std::string_view LLDPLayer::getSystemDescriptionView() const {
+    return getText(LLDP_TLV_TYPE_SYSTEM_DESCRIPTION);
+}
+
+std::string_view LLDPLayer::getPortDescriptionView() const {
+    return getText(LLDP_TLV_TYPE_PORT_DESCRIPTION);
+}
+
+std::string LLDPLayer::getSystemName() const {
+    return std::string(getSystemNameView());
 }
 
 uint16_t LLDPLayer::getTTL() const {
@@ -141,21 +190,11 @@ uint16_t LLDPLayer::getTTL() const {
 }
 
 std::string LLDPLayer::getSystemDescription() const {
-    TLV tlv = getTLV(LLDP_TLV_TYPE_SYSTEM_DESCRIPTION);
-    if (tlv.length == 0) {
-        return "";
-    }
-
-    return std::string(reinterpret_cast<const char*>(tlv.value), tlv.length);
+    return std::string(getSystemDescriptionView());
 }
 
 std::string LLDPLayer::getPortDescription() const {
-    TLV tlv = getTLV(LLDP_TLV_TYPE_PORT_DESCRIPTION);
-    if (tlv.length == 0) {
-        return "";
-    }
-
-    return std::string(reinterpret_cast<const char*>(tlv.value), tlv.length);
+    return std::string(getPortDescriptionView());
 }
 
 struct LLDPLayer::ManagementAddress LLDPLayer::getManagementAddress() const {
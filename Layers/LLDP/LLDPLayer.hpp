@@ -2,7 +2,10 @@
 #define LLDPLAYER_HPP
 
 #include <arpa/inet.h>
+#include <cstddef>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <unordered_map>
@@ -20,13 +23,20 @@
  * system description, system capabilities, and management address from the LLDP packet.
  * 
  * The LLDPLayer class also provides an overloaded operator for outputting LLDP layer information.
+ *
+ * The TLV index of a common LLDPDU fits in the layer itself, longer ones spill over to the
+ * scratch resource: parsing a frame does not touch the heap.
  */
 class LLDPLayer {
 public:
     // Constructor and Destructor
-    LLDPLayer(const uint8_t* data, size_t dataLen);
+    LLDPLayer(const uint8_t* data, size_t dataLen, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
     ~LLDPLayer();
 
+    // The TLV index points into the layer itself
+    LLDPLayer(const LLDPLayer&) = delete;
+    LLDPLayer& operator=(const LLDPLayer&) = delete;
+
     enum ChassisSubtype {
         CHASSIS_ID_SUBTYPE_RESERVED = 0,
         CHASSIS_ID_SUBTYPE_CHASSIS_COMPONENT = 1,
@@ -123,6 +133,13 @@ public:
     std::vector<struct LLDPLayer::SystemCapability> getSystemCapabilities() const;
     struct LLDPLayer::ManagementAddress getManagementAddress() const;
 
+    // The text fields as views into the frame, without the copies of the getters above
+    std::string_view getPortDescriptionView() const;
+    std::string_view getSystemNameView() const;
+    std::string_view getSystemDescriptionView() const;
+    // Whether getPortId() would return this text, without formatting it
+    bool portIdEquals(std::string_view portId) const;
+
     // Overloaded operator for outputting LLDP layer information
     friend std::ostream& operator<<(std::ostream& os, const LLDPLayer& layer);
 
@@ -140,11 +157,16 @@ private:
     // Helper functions
     void parseTLVs();
     TLV getTLV(uint8_t type) const;
+    // Value of a TLV as text, empty if the TLV is missing
+    std::string_view getText(uint8_t type) const;
     std::string capabilitiesToString(const std::vector<SystemCapability>& capabilities) const;
 
-    // Data structures for storing parsed TLVs
-    std::vector<TLV> tlvs;
-    const std::unordered_map<SystemCapabilities, std::string> capabilitiesMap = {
+    // Data structures for storing parsed TLVs, the first InlineTlvs ones in the layer
+    static constexpr size_t InlineTlvs = 16;
+    alignas(TLV) std::byte tlvBuffer[InlineTlvs * sizeof(TLV)];
+    std::pmr::monotonic_buffer_resource tlvResource;
+    std::pmr::vector<TLV> tlvs;
+    static inline const std::unordered_map<SystemCapabilities, std::string> capabilitiesMap = {
         {CAP_OTHER, "Other"},
         {CAP_REPEATER, "Repeater"},
         {CAP_BRIDGE, "Bridge"},
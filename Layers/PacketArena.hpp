@@ -0,0 +1,39 @@
+#ifndef PACKET_ARENA_HPP
+#define PACKET_ARENA_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * @class PacketArena
+ *
+ * @brief Scratch memory for the parser temporaries of one frame.
+ *
+ * A monotonic resource over an inline buffer: allocating bumps a pointer and freeing does
+ * nothing, the whole arena is released at once by reset() when the frame has been analyzed.
+ * A frame needing more than InlineSize bytes spills over to the global heap, released by
+ * the same reset().
+ *
+ * Nothing allocated from the arena may outlive the frame: the observations handed to the
+ * HostManager own their memory.
+ */
+class PacketArena {
+  public:
+    static constexpr size_t InlineSize = 16 << 10;
+
+    PacketArena() : resource(buffer.data(), buffer.size(), std::pmr::new_delete_resource()) {}
+
+    PacketArena(const PacketArena&) = delete;
+    PacketArena& operator=(const PacketArena&) = delete;
+
+    std::pmr::memory_resource* get() { return &resource; }
+    // Free everything allocated since the last reset, the next frame starts at the inline buffer
+    void reset() { resource.release(); }
+
+  private:
+    alignas(std::max_align_t) std::array<std::byte, InlineSize> buffer;
+    std::pmr::monotonic_buffer_resource resource;
+};
+
+#endif // PACKET_ARENA_HPP
@@ -3,30 +3,31 @@
 #include <sstream>
 #include <iomanip>
 
-SSDPLayer::SSDPLayer(const uint8_t* data, size_t length)
-  : rawData(data), rawDataLength(length) {
+SSDPLayer::SSDPLayer(const uint8_t* data, size_t length, std::pmr::memory_resource* scratch)
+  : rawData(data), rawDataLength(length), ssdpHeaders(scratch) {
     parseSSDPDU();
 }
 
 void SSDPLayer::parseSSDPDU() {
-  std::istringstream ss(std::string(reinterpret_cast<const char*>(rawData), rawDataLength));
-  // Get the SSDP type reading the first line in ss 
-  std::string firstLine;
-  std::getline(ss, firstLine);
+  std::string_view payload(reinterpret_cast<const char*>(rawData), rawDataLength);
+  // Get the SSDP type reading the first line of the payload
+  size_t end = payload.find('\n');
+  std::string_view firstLine = payload.substr(0, end);
 
-  if (firstLine.find("NOTIFY") != std::string::npos) {
+  if (firstLine.find("NOTIFY") != std::string_view::npos) {
     ssdpType = SSDPType::NOTIFY;
-  } else if (firstLine.find("M-SEARCH") != std::string::npos) {
+  } else if (firstLine.find("M-SEARCH") != std::string_view::npos) {
     ssdpType = SSDPType::MSEARCH;
   } 
   
-  std::string line;
-  while (std::getline(ss, line)) {
+  ssdpHeaders.reserve(16);
+  while (end != std::string_view::npos) {
+    size_t start = end + 1;
+    end = payload.find('\n', start);
+    std::string_view line = payload.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
     size_t pos = line.find(':');
-    if (pos != std::string::npos) {
-      std::string key = line.substr(0, pos);
-      std::string value = line.substr(pos + 1);
-      ssdpHeaders.push_back(std::make_pair(key, value));
+    if (pos != std::string_view::npos) {
+      ssdpHeaders.emplace_back(line.substr(0, pos), line.substr(pos + 1));
     }
   }
 }
@@ -35,7 +36,7 @@ SSDPLayer::SSDPType SSDPLayer::getSSDPType() const {
   return ssdpType;
 }
 
-std::vector<std::pair<std::string, std::string>> SSDPLayer::getSSDPHeaders() const {
+const std::pmr::vector<std::pair<std::string_view, std::string_view>>& SSDPLayer::getSSDPHeaders() const {
   return ssdpHeaders;
 }
 
@@ -2,8 +2,10 @@
 #define SSDP_LAYER_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
+#include <memory_resource>
 #include <ostream>
 
     class SSDPLayer {
@@ -12,9 +14,11 @@
             NOTIFY,
             MSEARCH
         };
-        SSDPLayer(const uint8_t* data, size_t length);
+        // The headers are views into the payload, indexed in the scratch resource
+        SSDPLayer(const uint8_t* data, size_t length, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
         SSDPType getSSDPType() const;
-        std::vector<std::pair<std::string, std::string>> getSSDPHeaders() const;
+        // Views into the payload, valid as long as the layer
+        const std::pmr::vector<std::pair<std::string_view, std::string_view>>& getSSDPHeaders() const;
         friend std::ostream& operator<<(std::ostream& os, const SSDPLayer& layer);
         
     private:
@@ -23,7 +27,7 @@
 
         SSDPType ssdpType;
         // Contains all the SSDP headers
-        std::vector<std::pair<std::string, std::string>> ssdpHeaders;
+        std::pmr::vector<std::pair<std::string_view, std::string_view>> ssdpHeaders;
 
         void parseSSDPDU();
     };
@@ -72,12 +72,33 @@ def generate_device_report(host, output_dir, menu_file_name="menu.html"):
     return os.path.basename(device_file)
 
 
-def generate_menu_report(json_file, output_dir):
+def apply_journal(data, journal_file):
+    """Applique au rapport complet les enregistrements du journal, le plus récent de chaque appareil l'emporte.
+
+    Un enregistrement EXPIRED retire l'appareil, évincé par le vieillissement des hôtes."""
+    hosts = {host['MAC']: host for host in data}
+    with open(journal_file, 'r') as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            record = json.loads(line)
+            # Les lignes WATERMARK ne décrivent pas d'appareil
+            if 'MAC' not in record:
+                continue
+            current = hosts.get(record['MAC'])
+            if current is None or record.get('SEQUENCE', 0) >= current.get('SEQUENCE', 0):
+                hosts[record['MAC']] = record
+    return [host for host in hosts.values() if not host.get('EXPIRED')]
+
+def generate_menu_report(json_file, output_dir, journal_file=None):
     """Génère un fichier HTML principal avec un tableau interactif des appareils détectés."""
     
     current_datetime = datetime.now().strftime("%d-%m-%Y %H:%M:%S")
     with open(json_file, 'r') as f:
         data = json.load(f)
+    if journal_file:
+        data = apply_journal(data, journal_file)
 
     os.makedirs(output_dir, exist_ok=True)
 
@@ -193,8 +214,8 @@ def generate_menu_report(json_file, output_dir):
     print(f"Rapport principal généré : {menu_file}")
 
 if __name__ == "__main__":
-    if len(sys.argv) != 3:
-        print("Usage: python generate_reports.py <input_json_file> <output_directory>")
+    if len(sys.argv) not in (3, 4):
+        print("Usage: python generate_reports.py <input_json_file> <output_directory> [journal_jsonl_file]")
         sys.exit(1)
 
     print(f"Generating report, please wait. It can take some time...")
@@ -202,4 +223,5 @@ if __name__ == "__main__":
     image_path_netprobe = os.path.abspath("../Rapport/images/Logo-NetProbe-detoure.webp")
     input_file = sys.argv[1]
     output_directory = sys.argv[2]
-    generate_menu_report(input_file, output_directory)
+    journal_file = sys.argv[3] if len(sys.argv) == 4 else None
+    generate_menu_report(input_file, output_directory, journal_file)
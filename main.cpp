@@ -6,6 +6,7 @@
 #include <cstdlib>
 #include <boost/asio.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/algorithm/string.hpp>
 #include <atomic>
 #include "CaptureManager.hpp"
 #include "Analyzers/DHCP/DHCPAnalyzer.hpp"
@@ -19,31 +20,54 @@
 #include "Hosts/HostManager.hpp"
 #include <atomic>
 
-void rearm_sigusr1(boost::asio::signal_set& signals, std::atomic<bool>& dumpHosts) {
+void rearm_sigusr1(boost::asio::signal_set& signals, std::atomic<bool>& dumpHosts, HostDumper& dumper) {
     // Asynchronously wait for SIGUSR1 signal
-    signals.async_wait([&signals, &dumpHosts](const boost::system::error_code& error, int signum) {
+    signals.async_wait([&signals, &dumpHosts, &dumper](const boost::system::error_code& error, int signum) {
         if (!error && signum == SIGUSR1) {
             std::cout << "Signal (" << signum << ") received, dumping hosts file..." << std::endl;
+            // The dump runs on this thread, the main loop only prints the statistics
+            dumper.dumpAsync();
             dumpHosts = true;
 
             // Rearm the handler for future signals
-            rearm_sigusr1(signals, dumpHosts);
+            rearm_sigusr1(signals, dumpHosts, dumper);
         } else if (error) {
             std::cerr << "Error handling signal: " << error.message() << std::endl;
         }
     });
 }
 
+void rearm_snapshot(boost::asio::steady_timer& timer, std::chrono::seconds interval, CaptureManager& captureManager,
+                    const std::string& snapshotFile) {
+    // Write the binary snapshot every interval from the IO thread
+    timer.expires_after(interval);
+    timer.async_wait([&timer, interval, &captureManager, snapshotFile](const boost::system::error_code& error) {
+        if (error) {
+            return;
+        }
+        captureManager.writeSnapshot(snapshotFile);
+        rearm_snapshot(timer, interval, captureManager, snapshotFile);
+    });
+}
+
 int main() {
     loadVendorDatabase("/netprobe/build/manuf", vendorDatabase);
 
-    // Get the network interface from environment variable
-    const char* interfaceEnv = "eth0";//getenv("INTERFACE");
+    // Get the network interfaces from environment variable, a comma separated list
+    const char* interfaceEnv = getenv("INTERFACE");
     if (!interfaceEnv) {
-        std::cerr << "Error: INTERFACE environment variable is not set." << std::endl;
-        return 1;
+        interfaceEnv = "eth0";
     }
     std::string interface = interfaceEnv;
+    std::vector<std::string> interfaces;
+    boost::split(interfaces, interface, boost::is_any_of(","));
+
+    // Replay a capture file instead of listening on the interface when set
+    const char* replayEnv = getenv("PCAP_FILE");
+
+    // Number of analysis threads, each owning a shard of the hosts
+    const char* workersEnv = getenv("WORKERS");
+    size_t workerCount = workersEnv ? std::stoul(workersEnv) : 1;
 
 
     std::atomic<bool> running(true); // Atomic flag for the infinite loop
@@ -72,64 +96,148 @@ int main() {
         }
     });
 
-    // Rearm the handler for SIGUSR1 signal
-    rearm_sigusr1(signals, dumpHosts);
+    // Create the capture manager, without a live device when replaying a file
+    CaptureManager captureManager = replayEnv ? CaptureManager() : CaptureManager(interfaces);
 
-    // Create the host manager
-    HostManager hostManager;
+    // Hosts report, written from the IO thread on SIGUSR1 and by autosave
+    const char* dumpFileEnv = getenv("DUMP_FILE");
+    HostDumper dumper(io_context, dumpFileEnv ? dumpFileEnv : "/netprobe/output/hosts.json",
+                      [&captureManager]() { return captureManager.getHostSnapshots(); });
+    const char* autosaveIntervalEnv = getenv("AUTOSAVE_INTERVAL");
+    const char* autosaveChangesEnv = getenv("AUTOSAVE_CHANGES");
+    // Autosave appends the changed hosts to a journal, with a full dump every FULL_DUMP_INTERVAL seconds
+    if (const char* journalEnv = getenv("JOURNAL_FILE")) {
+        const char* fullIntervalEnv = getenv("FULL_DUMP_INTERVAL");
+        dumper.setJournal(journalEnv, std::chrono::seconds(fullIntervalEnv ? std::stoul(fullIntervalEnv) : 3600));
+    }
+    if (autosaveIntervalEnv || autosaveChangesEnv) {
+        dumper.setAutosave(std::chrono::seconds(autosaveIntervalEnv ? std::stoul(autosaveIntervalEnv) : 0),
+                           autosaveChangesEnv ? std::stoull(autosaveChangesEnv) : 0);
+    }
+
+    // Binary snapshot of the hosts, loaded at startup and written every SNAPSHOT_INTERVAL seconds and on exit
+    const char* snapshotEnv = getenv("SNAPSHOT_FILE");
+    boost::asio::steady_timer snapshotTimer(io_context);
+    if (snapshotEnv) {
+        captureManager.setWarmStart(snapshotEnv);
+    }
+    const char* snapshotIntervalEnv = getenv("SNAPSHOT_INTERVAL");
+    // Observations since the last snapshot, logged ahead of the host store and replayed at startup
+    if (const char* walEnv = getenv("WAL_FILE")) {
+        const char* commitEnv = getenv("WAL_COMMIT_INTERVAL");
+        captureManager.setObservationLog(walEnv, std::chrono::milliseconds(commitEnv ? std::stoul(commitEnv) : 10));
+    }
+
+    // Distinct observations kept per host and protocol, HISTORY_DEPTH or HISTORY_DEPTH_<PROTOCOL>
+    const char* protocolNames[] = {"DHCP", "MDNS", "ARP", "SSDP", "LLDP", "CDP", "STP", "WOL"};
+    const char* historyDepthEnv = getenv("HISTORY_DEPTH");
+    for (size_t protocol = 0; protocol < 8; protocol++) {
+        const char* env = getenv(("HISTORY_DEPTH_" + std::string(protocolNames[protocol])).c_str());
+        if (env || historyDepthEnv) {
+            ObservationHistory::setCapacity(static_cast<ProtocolType>(protocol), std::stoul(env ? env : historyDepthEnv));
+        }
+    }
+
+    // Age observations out after IDLE_TIMEOUT seconds, or IDLE_TIMEOUT_<PROTOCOL>, honouring the protocol TTLs unless AGING_TTL=0
+    AgingPolicy agingPolicy;
+    const char* idleTimeoutEnv = getenv("IDLE_TIMEOUT");
+    for (size_t protocol = 0; protocol < agingPolicy.idleTimeouts.size(); protocol++) {
+        const char* env = getenv(("IDLE_TIMEOUT_" + std::string(protocolNames[protocol])).c_str());
+        if (env || idleTimeoutEnv) {
+            agingPolicy.idleTimeouts[protocol] = std::stoul(env ? env : idleTimeoutEnv);
+        }
+    }
+    if (const char* ttlEnv = getenv("AGING_TTL")) {
+        agingPolicy.honourTtl = std::string(ttlEnv) != "0";
+    }
+    captureManager.setAgingPolicy(agingPolicy);
+
+    // Rearm the handler for SIGUSR1 signal
+    rearm_sigusr1(signals, dumpHosts, dumper);
 
     // Start the IO context in a separate thread
     std::thread io_thread([&io_context]() { io_context.run(); });
 
-    // Create the capture manager
-    CaptureManager captureManager(interface);
-
-    // Create analyzers
-    DHCPAnalyzer dhcpAnalyzer(hostManager);
-    mDNSAnalyzer mdnsAnalyzer(hostManager);
-    ARPAnalyzer arpAnalyzer(hostManager);
-    STPAnalyzer stpAnalyzer(hostManager);
-    SSDPAnalyzer ssdpAnalyzer(hostManager);
-    CDPAnalyzer cdpAnalyzer(hostManager);
-    LLDPAnalyzer lldpAnalyzer(hostManager);
-    WOLAnalyzer wolAnalyzer(hostManager);
-
-    // Add analyzers to the manager
-    captureManager.addAnalyzer(&dhcpAnalyzer);
-    captureManager.addAnalyzer(&arpAnalyzer);
-    captureManager.addAnalyzer(&stpAnalyzer);
-    captureManager.addAnalyzer(&ssdpAnalyzer);
-    captureManager.addAnalyzer(&cdpAnalyzer);
-    captureManager.addAnalyzer(&lldpAnalyzer);
-    captureManager.addAnalyzer(&wolAnalyzer);
-
-    // Start capturing packets
-    std::cout << "Starting packet capture on interface: " << interface << std::endl;
+    captureManager.setWorkerCount(workerCount);
 
-    try {
-        captureManager.startCapture();
-
-        if (isInfinite) {
-            std::cout << "Capturing packets indefinitely. Press Ctrl+C to stop." << std::endl;
-
-            // Infinite loop controlled by the atomic flag
-            while (running) {
-                // Dump hosts to file if the atomic flag is set
-                if (dumpHosts) {
-                    hostManager.dumpHostsToFile("/netprobe/output/hosts.json");
-                    #ifdef DEBUG
-                    std::cout << hostManager.getHostsJson() << std::endl;
-                    #endif
-                    dumpHosts = false;
-                }
-                std::this_thread::sleep_for(std::chrono::seconds(1));
+    // Pre-size the host store, avoiding rehashes while a large network is discovered
+    if (const char* hostsEnv = getenv("EXPECTED_HOSTS")) {
+        captureManager.setExpectedHosts(std::stoul(hostsEnv));
+    }
+
+    // Read the TPACKET_V3 mmap ring directly instead of going through libpcap
+    const char* backendEnv = getenv("CAPTURE_BACKEND");
+    if (backendEnv && std::string(backendEnv) == "tpacket") {
+        TPacketCapture::Config tpacketConfig;
+        if (const char* env = getenv("TPACKET_BLOCK_SIZE")) tpacketConfig.blockSize = std::stoul(env);
+        if (const char* env = getenv("TPACKET_BLOCK_COUNT")) tpacketConfig.blockCount = std::stoul(env);
+        if (const char* env = getenv("TPACKET_FRAME_SIZE")) tpacketConfig.frameSize = std::stoul(env);
+        if (const char* env = getenv("TPACKET_BLOCK_TIMEOUT")) tpacketConfig.blockTimeoutMs = std::stoul(env);
+
+        // Spread the load over several sockets joined to one PACKET_FANOUT group
+        size_t sockets = 1;
+        if (const char* env = getenv("TPACKET_SOCKETS")) sockets = std::stoul(env);
+        if (const char* env = getenv("TPACKET_FANOUT")) {
+            std::string mode = env;
+            if (mode == "cpu") {
+                tpacketConfig.fanoutMode = TPacketCapture::FanoutMode::Cpu;
+            } else if (mode == "rollover") {
+                tpacketConfig.fanoutMode = TPacketCapture::FanoutMode::Rollover;
             }
+        }
+        captureManager.setCaptureBackend(CaptureBackend::TPacketV3, tpacketConfig, sockets);
+    }
+
+    // Override the kernel filter built from the analyzers, an empty value disables filtering
+    if (const char* filterEnv = getenv("CAPTURE_FILTER")) {
+        captureManager.setCaptureFilter(filterEnv);
+    }
+
+    // Add analyzers to the manager, each worker gets its own instances bound to its host shard
+    captureManager.addAnalyzer<DHCPAnalyzer>();
+    captureManager.addAnalyzer<ARPAnalyzer>();
+    captureManager.addAnalyzer<STPAnalyzer>();
+    captureManager.addAnalyzer<SSDPAnalyzer>();
+    captureManager.addAnalyzer<CDPAnalyzer>();
+    captureManager.addAnalyzer<LLDPAnalyzer>();
+    captureManager.addAnalyzer<WOLAnalyzer>();
+
+    try {
+        if (replayEnv) {
+            // Offline mode, process the whole file and exit
+            std::cout << "Replaying capture file: " << replayEnv << std::endl;
+            captureManager.replayFile(replayEnv);
         } else {
-            std::cout << "Capturing packets for " << duration << " seconds" << std::endl;
+            // Start capturing packets
+            std::cout << "Starting packet capture on interfaces: " << interface << std::endl;
+            captureManager.startCapture();
+            // Armed once the workers exist, the snapshots are written from the IO thread
+            if (snapshotEnv && snapshotIntervalEnv) {
+                rearm_snapshot(snapshotTimer, std::chrono::seconds(std::stoul(snapshotIntervalEnv)), captureManager, snapshotEnv);
+            }
+
+            if (isInfinite) {
+                std::cout << "Capturing packets indefinitely. Press Ctrl+C to stop." << std::endl;
+
+                // Infinite loop controlled by the atomic flag
+                while (running) {
+                    // Print the statistics along with the dump requested by SIGUSR1
+                    if (dumpHosts) {
+                        captureManager.printCaptureStats();
+                        #ifdef DEBUG
+                        std::cout << captureManager.getHostsJson() << std::endl;
+                        #endif
+                        dumpHosts = false;
+                    }
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                }
+            } else {
+                std::cout << "Capturing packets for " << duration << " seconds" << std::endl;
 
-            // Finite loop for the given duration
-            for (int i = 0; i < duration; i++) {
-                std::this_thread::sleep_for(std::chrono::seconds(1));
+                // Finite loop for the given duration
+                for (int i = 0; i < duration; i++) {
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                }
             }
         }
     } catch (const std::exception& e) {
@@ -140,18 +248,30 @@ int main() {
     try {
         captureManager.stopCapture();
         std::cout << "Packet capture stopped." << std::endl;
+        if (!replayEnv) {
+            captureManager.printCaptureStats();
+        }
     } catch (const std::exception& e) {
         std::cerr << "Exception occurred while stopping capture: " << e.what() << std::endl;
     }
 
+    // Cancel autosave, the snapshot timer and the pending signal handlers, and wait for the IO
+    // thread to return: a periodic snapshot or dump it is writing completes first, so the final
+    // ones below are written last
+    dumper.stop();
+    boost::asio::post(io_context, [&snapshotTimer]() { snapshotTimer.cancel(); });
+    io_context.stop();
+    io_thread.join();
+
     // Print the host map
-    hostManager.printHostMap();
-    //hostManager.dumpHostsToFile("/netprobe/output/hosts.json");
-    hostManager.dumpHostsToFile("./hosts.json");
+    captureManager.printHostMap();
+    //captureManager.dumpHostsToFile("/netprobe/output/hosts.json");
+    captureManager.dumpHostsToFile("./hosts.json");
+    if (snapshotEnv) {
+        captureManager.writeSnapshot(snapshotEnv);
+    }
 
     std::cout << "Program terminated." << std::endl;
-
-    io_thread.join();
     return 0;
 }
 